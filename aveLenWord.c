@@ -1,5 +0,0 @@
-# include <file.h>
-
-int main(void) {
-
-}
\ No newline at end of file
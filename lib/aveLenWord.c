@@ -0,0 +1,47 @@
+//
+// Статистика слів: середня довжина, кількість слів і речень, гістограма довжин.
+// Використання: aveLenWord [файл...] -- без файлів читає stdin.
+//
+#include <stdio.h>
+#include "str_wordstat.h"
+
+static void print_stat(const my_str_wordstat_t *stat) {
+	printf("words: %zu\n", stat->words);
+	printf("sentences: %zu\n", stat->sentences);
+	printf("lines: %zu\n", stat->lines);
+	printf("average word length: %.3f\n", my_str_wordstat_average(stat));
+	printf("length histogram:\n");
+	for (size_t i = 1; i < MY_STR_WORDSTAT_HIST; i++) {
+		if (stat->hist[i] > 0) {
+			printf("%4zu%s %zu\n", i, i == MY_STR_WORDSTAT_HIST - 1 ? "+" : " ", stat->hist[i]);
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	my_str_wordstat_t stat;
+	my_str_wordstat_init(&stat);
+	if (argc < 2) {
+		if (my_str_wordstat_file(&stat, stdin) != 0) {
+			fprintf(stderr, "aveLenWord: read error\n");
+			return 1;
+		}
+	}
+	for (int i = 1; i < argc; i++) {
+		FILE *file = fopen(argv[i], "rb");
+		if (file == NULL) {
+			fprintf(stderr, "aveLenWord: cannot open %s\n", argv[i]);
+			return 1;
+		}
+		// Кожен файл -- окремий текст: слово чи речення не переходять у наступний.
+		stat.after_word = 0;
+		int rc = my_str_wordstat_file(&stat, file);
+		fclose(file);
+		if (rc != 0) {
+			fprintf(stderr, "aveLenWord: read error in %s\n", argv[i]);
+			return 1;
+		}
+	}
+	print_stat(&stat);
+	return 0;
+}
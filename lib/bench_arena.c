@@ -0,0 +1,116 @@
+//
+// Пропускна здатність створення і звільнення стрічок: malloc() проти арен потоків.
+// Використання: bench_arena [потоків [стрічок на потік]] -- без аргументів
+// проходить 1, 2, 4 .. потоків до кількості ядер, по 1000000 стрічок на потік.
+// Кожна стрічка росте через my_str_reserve(), а звільняє її сусідній потік.
+//
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "stringg.h"
+#include "str_arena.h"
+#include "str_parallel.h"
+
+#define BATCH 4096
+
+struct bench {
+	size_t threads;
+	size_t per_thread;
+	int arena;
+	my_str_t *batches; // По BATCH стрічок на потік
+	pthread_barrier_t barrier;
+};
+
+struct worker {
+	struct bench *bench;
+	size_t id;
+};
+
+static void *worker(void *raw) {
+	struct worker *w = raw;
+	struct bench *b = w->bench;
+	my_str_t *own = b->batches + w->id * BATCH;
+	my_str_t *next = b->batches + (w->id + 1) % b->threads * BATCH;
+	unsigned seed = (unsigned) w->id + 1;
+	for (size_t done = 0; done < b->per_thread; done += BATCH) {
+		// Створити свою порцію: 8..64 байт, потім дорости до 16..1024.
+		for (size_t i = 0; i < BATCH; i++) {
+			size_t first = 8 + (size_t) rand_r(&seed) % 57;
+			if (b->arena) {
+				my_str_create_arena(&own[i], first);
+			} else {
+				my_str_create(&own[i], first);
+			}
+			size_t len = 16 + (size_t) rand_r(&seed) % 1009;
+			my_str_reserve(&own[i], len);
+			memset(own[i].data, 'x', len);
+			own[i].size_m = len;
+		}
+		pthread_barrier_wait(&b->barrier);
+		// Звільнити порцію сусіда -- для арени це віддалені звільнення.
+		for (size_t i = 0; i < BATCH; i++) {
+			my_str_free(&next[i]);
+		}
+		pthread_barrier_wait(&b->barrier);
+	}
+	return NULL;
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+//! Мільйонів стрічок (створення, ріст і звільнення) за секунду.
+static double run(size_t threads, size_t per_thread, int arena) {
+	struct bench b = {threads, per_thread, arena, calloc(threads * BATCH, sizeof(my_str_t)), {{0}}};
+	struct worker *workers = malloc(sizeof(struct worker) * threads);
+	pthread_t *handles = malloc(sizeof(pthread_t) * threads);
+	pthread_barrier_init(&b.barrier, NULL, (unsigned) threads);
+	double start = now();
+	for (size_t t = 0; t < threads; t++) {
+		workers[t].bench = &b;
+		workers[t].id = t;
+		pthread_create(&handles[t], NULL, worker, &workers[t]);
+	}
+	for (size_t t = 0; t < threads; t++) {
+		pthread_join(handles[t], NULL);
+	}
+	double elapsed = now() - start;
+	pthread_barrier_destroy(&b.barrier);
+	free(handles);
+	free(workers);
+	free(b.batches);
+	size_t total = threads * ((per_thread + BATCH - 1) / BATCH * BATCH);
+	return (double) total / 1e6 / elapsed;
+}
+
+static void report(size_t threads, size_t per_thread) {
+	double m = run(threads, per_thread, 0);
+	double a = run(threads, per_thread, 1);
+	printf("%7zu %12.2f %12.2f %8.2fx\n", threads, m, a, a / m);
+}
+
+int main(int argc, char **argv) {
+	size_t threads = argc > 1 ? (size_t) atol(argv[1]) : 0;
+	size_t per_thread = argc > 2 ? (size_t) atol(argv[2]) : 1000000;
+	if (per_thread == 0) {
+		fprintf(stderr, "usage: bench_arena [threads [strings_per_thread]]\n");
+		return 1;
+	}
+	printf("threads  malloc M/s    arena M/s  speedup\n");
+	if (threads > 0) {
+		report(threads, per_thread);
+		return 0;
+	}
+	size_t cpus = my_str_cpu_count();
+	for (size_t t = 1; t < cpus; t *= 2) {
+		report(t, per_thread);
+	}
+	report(cpus, per_thread);
+	return 0;
+}
@@ -0,0 +1,131 @@
+//
+// Швидкість побудови інвертованого індексу і затримка запитів до нього.
+// Використання: bench_invidx [документів [слів у документі [запитів]]]
+// -- за замовчуванням 200000, 50 і 10000. Частоти слів -- за законом Ципфа.
+//
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "str_invidx.h"
+
+#define VOCAB 50000
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+//! Номер слова з розподілом Ципфа (s = 1) через обернену функцію розподілу.
+static size_t zipf(const double *cdf, unsigned *seed) {
+	double u = (double) rand_r(seed) / ((double) RAND_MAX + 1);
+	size_t lo = 0, hi = VOCAB - 1;
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		if (cdf[mid] < u) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static int cmp_double(const void *a, const void *b) {
+	double x = *(const double *) a, y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+
+//! Запити з двох слів: одне з першої сотні, друге -- будь-яке.
+static void bench_queries(const my_str_invidx_t *idx, char words[][8], const double *cdf, size_t queries,
+						  int (*query)(const my_str_invidx_t *, const my_str_view_t *, size_t, my_str_invidx_result_t *),
+						  const char *name) {
+	double *lat = malloc(sizeof(double) * queries);
+	my_str_invidx_result_t res;
+	my_str_invidx_result_init(&res);
+	unsigned seed = 7;
+	size_t hits = 0;
+	for (size_t q = 0; q < queries; q++) {
+		my_str_view_t terms[2] = {my_str_view_cstr(words[(size_t) rand_r(&seed) % 100]),
+								  my_str_view_cstr(words[zipf(cdf, &seed)])};
+		double t = now();
+		query(idx, terms, 2, &res);
+		lat[q] = now() - t;
+		hits += res.size_m;
+	}
+	qsort(lat, queries, sizeof(double), cmp_double);
+	double sum = 0;
+	for (size_t q = 0; q < queries; q++) {
+		sum += lat[q];
+	}
+	printf("%s: avg %.1f us, p50 %.1f us, p99 %.1f us, avg %.0f docs/result\n", name, sum / (double) queries * 1e6,
+		   lat[queries / 2] * 1e6, lat[queries * 99 / 100] * 1e6, (double) hits / (double) queries);
+	my_str_invidx_result_free(&res);
+	free(lat);
+}
+
+int main(int argc, char **argv) {
+	size_t ndocs = argc > 1 ? (size_t) atol(argv[1]) : 200000;
+	size_t doc_words = argc > 2 ? (size_t) atol(argv[2]) : 50;
+	size_t queries = argc > 3 ? (size_t) atol(argv[3]) : 10000;
+	if (ndocs == 0 || doc_words == 0 || queries == 0) {
+		fprintf(stderr, "usage: bench_invidx [docs [words_per_doc [queries]]]\n");
+		return 1;
+	}
+
+	static char words[VOCAB][8];
+	static double cdf[VOCAB];
+	double norm = 0;
+	for (size_t w = 0; w < VOCAB; w++) {
+		snprintf(words[w], sizeof(words[w]), "w%zu", w);
+		norm += 1.0 / (double) (w + 1);
+		cdf[w] = norm;
+	}
+	for (size_t w = 0; w < VOCAB; w++) {
+		cdf[w] /= norm;
+	}
+
+	// Тексти генеруються заздалегідь, щоб час побудови був чистим.
+	char *text = malloc(ndocs * doc_words * 8);
+	size_t *ends = malloc(sizeof(size_t) * ndocs);
+	size_t len = 0;
+	unsigned seed = 1;
+	for (size_t d = 0; d < ndocs; d++) {
+		for (size_t k = 0; k < doc_words; k++) {
+			const char *w = words[zipf(cdf, &seed)];
+			size_t wl = strlen(w);
+			memcpy(text + len, w, wl);
+			len += wl;
+			text[len++] = ' ';
+		}
+		ends[d] = len;
+	}
+
+	my_str_invidx_t idx;
+	if (my_str_invidx_create(&idx) != 0) {
+		return 1;
+	}
+	double start = now();
+	size_t beg = 0;
+	for (size_t d = 0; d < ndocs; d++) {
+		my_str_view_t doc = {text + beg, ends[d] - beg};
+		if (my_str_invidx_add(&idx, doc, " ", NULL) != 0) {
+			fprintf(stderr, "bench_invidx: add failed\n");
+			return 1;
+		}
+		beg = ends[d];
+	}
+	double elapsed = now() - start;
+	printf("build: %zu docs, %.1f MiB in %.3f s -- %.0f docs/s, %.1f MiB/s\n", ndocs, (double) len / (1 << 20),
+		   elapsed, (double) ndocs / elapsed, (double) len / (1 << 20) / elapsed);
+
+	bench_queries(&idx, words, cdf, queries, my_str_invidx_and, "AND");
+	bench_queries(&idx, words, cdf, queries, my_str_invidx_or, "OR ");
+
+	my_str_invidx_free(&idx);
+	free(ends);
+	free(text);
+	return 0;
+}
@@ -0,0 +1,101 @@
+//
+// Пропускна здатність my_str_reader_t на каналі.
+// Використання: bench_reader [мегабайт [довжина запису]] -- за замовчуванням 256 і 64.
+//
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "str_reader.h"
+
+#define WRITE_CHUNK (64u << 10)
+
+struct job {
+	int fd;
+	size_t total;
+	size_t record_len;
+};
+
+static void *writer(void *arg) {
+	struct job *job = arg;
+	// Блок із цілих записів, що повторюється, доки не набереться total.
+	char *block = malloc(WRITE_CHUNK);
+	for (size_t i = 0; i < WRITE_CHUNK; i++) {
+		block[i] = (i + 1) % job->record_len == 0 ? '\n' : (char) ('a' + i % 26);
+	}
+	size_t sent = 0;
+	while (sent < job->total) {
+		size_t len = job->total - sent < WRITE_CHUNK ? job->total - sent : WRITE_CHUNK;
+		ssize_t n = write(job->fd, block, len);
+		if (n < 0) {
+			break;
+		}
+		sent += (size_t) n;
+	}
+	free(block);
+	close(job->fd);
+	return NULL;
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+	size_t mb = argc > 1 ? (size_t) atol(argv[1]) : 256;
+	size_t record_len = argc > 2 ? (size_t) atol(argv[2]) : 64;
+	if (mb == 0 || record_len < 2) {
+		fprintf(stderr, "usage: bench_reader [megabytes [record_length]]\n");
+		return 1;
+	}
+	int fds[2];
+	if (pipe(fds) != 0 || fcntl(fds[0], F_SETFL, O_NONBLOCK) != 0) {
+		perror("bench_reader: pipe");
+		return 1;
+	}
+	struct job job = {fds[1], mb << 20, record_len};
+	my_str_reader_t reader;
+	if (my_str_reader_create(&reader, '\n', 0) != 0) {
+		return 1;
+	}
+
+	double start = now();
+	pthread_t thread;
+	pthread_create(&thread, NULL, writer, &job);
+	size_t records = 0;
+	size_t bytes = 0;
+	int rc;
+	do {
+		rc = my_str_reader_fill(&reader, fds[0]);
+		if (rc == -1) {
+			struct pollfd p = {fds[0], POLLIN, 0};
+			poll(&p, 1, -1);
+			continue;
+		}
+		if (rc < 0) {
+			fprintf(stderr, "bench_reader: read error\n");
+			return 1;
+		}
+		my_str_view_t rec;
+		while (my_str_reader_next(&reader, &rec) == 1) {
+			records++;
+			bytes += rec.size_m + 1;
+		}
+	} while (rc != 0);
+	pthread_join(thread, NULL);
+	double elapsed = now() - start;
+
+	printf("records: %zu, bytes: %zu\n", records, bytes);
+	printf("time: %.3f s, %.1f MiB/s, %.2f M records/s\n", elapsed,
+		   (double) bytes / (1 << 20) / elapsed, (double) records / 1e6 / elapsed);
+	my_str_reader_free(&reader);
+	close(fds[0]);
+	return 0;
+}
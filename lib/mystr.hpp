@@ -0,0 +1,197 @@
+#ifndef STRLIB_MYSTR_HPP
+#define STRLIB_MYSTR_HPP
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <utility>
+
+extern "C" {
+#include "stringg.h"
+#include "str_view.h"
+}
+
+//! C++17-обгортка над my_str_t: володіє буфером і звільняє його сама.
+//! Переміщення лише передає буфер, тож повернення стрічки з функції
+//! нічого не копіює. Копія -- тільки явна: string b(a) або a.copy().
+//! Помилки виділення пам'яті -- std::bad_alloc.
+namespace mystr {
+
+class string
+{
+public:
+	string() noexcept : str_{0, 0, nullptr} {}
+
+	explicit string(std::string_view s) : string()
+	{
+		append(s);
+	}
+
+	//! Стати власником стрічки з C (після цього не викликайте для неї my_str_free()).
+	static string adopt(my_str_t str)
+	{
+		string s;
+		s.str_ = str;
+		s.terminate();
+		return s;
+	}
+
+	explicit string(const string& other) : string(other.view()) {}
+	string& operator=(const string&) = delete;
+
+	string(string&& other) noexcept : str_(other.str_)
+	{
+		other.str_ = my_str_t{0, 0, nullptr};
+	}
+
+	string& operator=(string&& other) noexcept
+	{
+		if (this != &other) {
+			reset();
+			str_ = other.str_;
+			other.str_ = my_str_t{0, 0, nullptr};
+		}
+		return *this;
+	}
+
+	~string()
+	{
+		reset();
+	}
+
+	string copy() const
+	{
+		return string(*this);
+	}
+
+	//! Віддати буфер у C -- звільняти його тоді через my_str_free().
+	my_str_t release() noexcept
+	{
+		my_str_t str = str_;
+		str_ = my_str_t{0, 0, nullptr};
+		return str;
+	}
+
+	//! Для виклику функцій бібліотеки напряму.
+	my_str_t* get() noexcept { return &str_; }
+	const my_str_t* get() const noexcept { return &str_; }
+
+	std::size_t size() const noexcept { return str_.size_m; }
+	std::size_t capacity() const noexcept { return str_.capacity_m; }
+	bool empty() const noexcept { return str_.size_m == 0; }
+	const char* data() const noexcept { return str_.data ? str_.data : ""; }
+	const char* begin() const noexcept { return data(); }
+	const char* end() const noexcept { return data() + size(); }
+
+	//! Вміст завжди завершується нулем (див. append()).
+	const char* c_str() const noexcept { return data(); }
+
+	char& operator[](std::size_t i) noexcept { return str_.data[i]; }
+	char operator[](std::size_t i) const noexcept { return str_.data[i]; }
+
+	std::string_view view() const noexcept { return std::string_view(data(), size()); }
+	operator std::string_view() const noexcept { return view(); }
+	my_str_view_t cview() const noexcept { return my_str_view_t{data(), size()}; }
+
+	void reserve(std::size_t n)
+	{
+		if (n > str_.capacity_m) {
+			grow(n);
+		}
+	}
+
+	void clear() noexcept
+	{
+		str_.size_m = 0;
+		if (str_.data) {
+			str_.data[0] = '\0';
+		}
+	}
+
+	void swap(string& other) noexcept
+	{
+		std::swap(str_, other.str_);
+	}
+
+	//! Дописати одним my_str_append_view(); s може вказувати і на саму стрічку.
+	//! Місце під завершальний нуль резервується заздалегідь (з подвоєнням),
+	//! тож дописування виділяє пам'ять щонайбільше раз і копіює вміст один раз.
+	string& append(std::string_view s)
+	{
+		std::size_t need = str_.size_m + s.size() + 1;
+		if (need > str_.capacity_m) {
+			const char* old = str_.data;
+			bool inside = old != nullptr && s.data() >= old && s.data() < old + str_.size_m;
+			std::size_t off = inside ? static_cast<std::size_t>(s.data() - old) : 0;
+			grow(need > str_.capacity_m * 2 ? need : str_.capacity_m * 2);
+			if (inside) {
+				s = std::string_view(str_.data + off, s.size());
+			}
+		}
+		if (my_str_append_view(&str_, my_str_view_t{s.data(), s.size()}) != 0) {
+			throw std::bad_alloc();
+		}
+		str_.data[str_.size_m] = '\0';
+		return *this;
+	}
+
+	string& operator+=(std::string_view s) { return append(s); }
+	string& operator+=(const string& s) { return append(s.view()); }
+	string& operator+=(char c) { return append(std::string_view(&c, 1)); }
+
+	friend bool operator==(const string& a, const string& b) noexcept { return a.view() == b.view(); }
+	friend bool operator!=(const string& a, const string& b) noexcept { return a.view() != b.view(); }
+
+	//! Ліва стрічка-тимчасова дописується на місці і переміщується в результат.
+	friend string operator+(string&& a, std::string_view b)
+	{
+		a.append(b);
+		return std::move(a);
+	}
+
+	friend string operator+(const string& a, std::string_view b)
+	{
+		string s;
+		s.reserve(a.size() + b.size());
+		s.append(a.view());
+		s.append(b);
+		return s;
+	}
+
+private:
+	my_str_t str_;
+
+	void reset() noexcept
+	{
+		if (str_.data) {
+			my_str_free(&str_);
+		}
+	}
+
+	void grow(std::size_t n)
+	{
+		if (my_str_reserve(&str_, n) != 0 || str_.data == nullptr) {
+			throw std::bad_alloc();
+		}
+	}
+
+	//! Місце під завершальний нуль для стрічки, отриманої з C.
+	void terminate()
+	{
+		if (str_.data == nullptr) {
+			return;
+		}
+		if (str_.size_m >= str_.capacity_m) {
+			grow(str_.size_m * 2 + 1);
+		}
+		str_.data[str_.size_m] = '\0';
+	}
+};
+
+inline void swap(string& a, string& b) noexcept
+{
+	a.swap(b);
+}
+
+} // namespace mystr
+#endif //STRLIB_MYSTR_HPP
@@ -0,0 +1,194 @@
+//
+// Наближений пошук підстрічки: bitap із k помилками (Ву-Манбер).
+//
+#include <stdlib.h>
+#include <string.h>
+#include "str_approx.h"
+
+//! Підготувати пошук pattern із не більше ніж k помилками.
+//! Після використання -- викличте my_str_approx_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять,
+//! -3 -- k не менше довжини зразка (збігалося б усе), 0 -- все ОК.
+int my_str_approx_create(my_str_approx_t *ap, my_str_view_t pattern, size_t k, int flags) {
+	if (ap == NULL || pattern.data == NULL) {
+		return -1;
+	}
+	if (k >= pattern.size_m) {
+		return -3;
+	}
+	memset(ap, 0, sizeof(*ap));
+	ap->size_m = pattern.size_m;
+	ap->words = (pattern.size_m + 63) / 64;
+	ap->k = k;
+	ap->flags = flags;
+	ap->masks = calloc(256 * ap->words + 2 * (k + 1) * ap->words, sizeof(uint64_t));
+	if (ap->masks == NULL) {
+		return -2;
+	}
+	ap->state = ap->masks + 256 * ap->words;
+	ap->prev = ap->state + (k + 1) * ap->words;
+	for (size_t i = 0; i < pattern.size_m; i++) {
+		ap->masks[(unsigned char) pattern.data[i] * ap->words + i / 64] |= 1ull << (i % 64);
+	}
+	my_str_approx_reset(ap);
+	return 0;
+}
+
+void my_str_approx_free(my_str_approx_t *ap) {
+	if (ap != NULL) {
+		free(ap->masks);
+		ap->masks = NULL;
+	}
+}
+
+//! Почати новий потік: забути прочитане й позицію.
+void my_str_approx_reset(my_str_approx_t *ap) {
+	size_t words = ap->words;
+	memset(ap->state, 0, sizeof(uint64_t) * (ap->k + 1) * words);
+	// Без жодного байта тексту перші d символів зразка можна лише видалити.
+	if (!(ap->flags & MY_STR_APPROX_SUBST)) {
+		for (size_t d = 1; d <= ap->k; d++) {
+			for (size_t i = 0; i < d; i++) {
+				ap->state[d * words + i / 64] |= 1ull << (i % 64);
+			}
+		}
+	}
+	ap->chunk.data = NULL;
+	ap->chunk.size_m = 0;
+	ap->at = 0;
+	ap->offset = 0;
+}
+
+//! Подати наступну порцію потоку (наприклад, запис із my_str_reader_next()
+//! чи прочитаний блок). Попередня має бути вичерпана my_str_approx_next().
+//! Збіги, що перетинають межу порцій, теж знаходяться.
+void my_str_approx_feed(my_str_approx_t *ap, my_str_view_t chunk) {
+	ap->offset += ap->at;
+	ap->chunk = chunk;
+	ap->at = 0;
+}
+
+//! Зсув багатослівного стану на 1 вліво із вставкою одиниці в біт 0.
+static inline void shift_in(uint64_t *out, const uint64_t *in, size_t words) {
+	uint64_t carry = 1;
+	for (size_t w = 0; w < words; w++) {
+		uint64_t v = in[w];
+		out[w] = (v << 1) | carry;
+		carry = v >> 63;
+	}
+}
+
+//! Один байт для зразків до 64 символів: увесь стан -- по слову на d.
+static inline void step_word(my_str_approx_t *ap, uint64_t b) {
+	uint64_t *r = ap->state;
+	uint64_t old = r[0];
+	r[0] = ((old << 1) | 1) & b;
+	if (ap->flags & MY_STR_APPROX_SUBST) {
+		for (size_t d = 1; d <= ap->k; d++) {
+			uint64_t cur = r[d];
+			r[d] = (((cur << 1) | 1) & b) | (old << 1) | 1;
+			old = cur;
+		}
+	} else {
+		for (size_t d = 1; d <= ap->k; d++) {
+			uint64_t cur = r[d];
+			// Збіг | вставка в тексті | заміна | пропуск символу зразка.
+			r[d] = (((cur << 1) | 1) & b) | old | (old << 1) | (r[d - 1] << 1) | 1;
+			old = cur;
+		}
+	}
+}
+
+//! Те саме для довгих зразків -- блоками по 64 біти з перенесенням.
+static void step_blocks(my_str_approx_t *ap, const uint64_t *b) {
+	size_t words = ap->words;
+	uint64_t *r = ap->state;
+	uint64_t *prev = ap->prev;
+	memcpy(prev, r, sizeof(uint64_t) * (ap->k + 1) * words);
+	shift_in(r, prev, words);
+	for (size_t w = 0; w < words; w++) {
+		r[w] &= b[w];
+	}
+	for (size_t d = 1; d <= ap->k; d++) {
+		uint64_t *cur = r + d * words;
+		const uint64_t *old_cur = prev + d * words;
+		const uint64_t *old = prev + (d - 1) * words;
+		const uint64_t *upper = r + (d - 1) * words;
+		uint64_t c_cur = 1;
+		uint64_t c_old = 1;
+		uint64_t c_upper = 1;
+		for (size_t w = 0; w < words; w++) {
+			uint64_t v = ((old_cur[w] << 1) | c_cur) & b[w];
+			v |= (old[w] << 1) | c_old;
+			if (!(ap->flags & MY_STR_APPROX_SUBST)) {
+				v |= old[w] | (upper[w] << 1) | c_upper;
+			}
+			c_cur = old_cur[w] >> 63;
+			c_old = old[w] >> 63;
+			c_upper = upper[w] >> 63;
+			cur[w] = v;
+		}
+	}
+}
+
+//! Наступне входження в поданій порції: *end -- позиція в потоці одразу
+//! за ним, *errors -- найменша кількість помилок (обидва можна NULL).
+//! Кінці сусідніх наближених входжень ідуть підряд -- кожен окремо.
+//! 1 -- знайдено, 0 -- порцію вичерпано, -1 -- нульовий вказівник.
+int my_str_approx_next(my_str_approx_t *ap, uint64_t *end, size_t *errors) {
+	if (ap == NULL || ap->masks == NULL) {
+		return -1;
+	}
+	size_t words = ap->words;
+	size_t top = (ap->size_m - 1) / 64;
+	uint64_t hit = 1ull << ((ap->size_m - 1) % 64);
+	const unsigned char *data = (const unsigned char *) ap->chunk.data;
+	while (ap->at < ap->chunk.size_m) {
+		const uint64_t *b = ap->masks + data[ap->at++] * words;
+		if (words == 1) {
+			step_word(ap, *b);
+		} else {
+			step_blocks(ap, b);
+		}
+		if (!(ap->state[ap->k * words + top] & hit)) {
+			continue;
+		}
+		size_t d = 0;
+		while (!(ap->state[d * words + top] & hit)) {
+			d++;
+		}
+		if (end != NULL) {
+			*end = ap->offset + ap->at;
+		}
+		if (errors != NULL) {
+			*errors = d;
+		}
+		return 1;
+	}
+	return 0;
+}
+
+//! Аналог my_str_find() з допуском до k вставок, видалень і замін:
+//! позиція першого байта ПІСЛЯ першого входження, починаючи з from.
+//! (size_t)-1 -- не знайдено, нульовий вказівник чи k >= довжини зразка.
+size_t my_str_view_find_approx(my_str_view_t str, my_str_view_t tofind, size_t k, size_t from) {
+	my_str_approx_t ap;
+	if (str.data == NULL || from > str.size_m) {
+		return (size_t) -1;
+	}
+	if (my_str_approx_create(&ap, tofind, k, 0) != 0) {
+		return (size_t) -1;
+	}
+	uint64_t end;
+	my_str_approx_feed(&ap, my_str_view_sub(str, from, str.size_m));
+	size_t pos = my_str_approx_next(&ap, &end, NULL) == 1 ? from + (size_t) end : (size_t) -1;
+	my_str_approx_free(&ap);
+	return pos;
+}
+
+size_t my_str_find_approx(const my_str_t *str, const my_str_t *tofind, size_t k, size_t from) {
+	if (str == NULL || tofind == NULL) {
+		return (size_t) -1;
+	}
+	return my_str_view_find_approx(my_str_view(str), my_str_view(tofind), k, from);
+}
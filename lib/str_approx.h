@@ -0,0 +1,33 @@
+#ifndef STRLIB_APPROX_H
+#define STRLIB_APPROX_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+
+#define MY_STR_APPROX_SUBST 1 // Лише заміни (Геммінг), без вставок і видалень
+
+//! Наближений пошук (bitap, Ву-Манбер): кінці входжень зразка з
+//! не більше ніж k помилками. Стан переживає межі порцій тексту.
+typedef struct
+{
+	size_t size_m;		// Довжина зразка
+	size_t words;		// 64-бітних слів на стан
+	size_t k;			// Допустима кількість помилок
+	int flags;
+	uint64_t* masks;	// masks[c * words + w] -- позиції байта c у зразку
+	uint64_t* state;	// state[d * words + w] -- префікси з d помилками
+	uint64_t* prev;		// Стан перед поточним байтом
+	my_str_view_t chunk; // Поточна порція
+	size_t at;			// Наступний байт порції
+	uint64_t offset;	// Позиція початку порції в усьому потоці
+} my_str_approx_t;
+
+int my_str_approx_create(my_str_approx_t* ap, my_str_view_t pattern, size_t k, int flags);
+void my_str_approx_free(my_str_approx_t* ap);
+void my_str_approx_reset(my_str_approx_t* ap);
+void my_str_approx_feed(my_str_approx_t* ap, my_str_view_t chunk);
+int my_str_approx_next(my_str_approx_t* ap, uint64_t* end, size_t* errors);
+size_t my_str_view_find_approx(my_str_view_t str, my_str_view_t tofind, size_t k, size_t from);
+size_t my_str_find_approx(const my_str_t* str, const my_str_t* tofind, size_t k, size_t from);
+#endif //STRLIB_APPROX_H
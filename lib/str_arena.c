@@ -0,0 +1,260 @@
+//
+// Арени потоків для буферів стрічок з чергами віддалених звільнень.
+//
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "str_arena.h"
+
+#define SEG_SHIFT 22 // Сегмент -- 4 МіБ, вирівняний на свій розмір
+#define SEG_SIZE ((size_t) 1 << SEG_SHIFT)
+#define PAGE_SHIFT 16 // Сторінка -- 64 КіБ блоків одного класу
+#define PAGES (SEG_SIZE >> PAGE_SHIFT)
+#define MIN_SHIFT 4 // Класи: 16, 32, .. MY_STR_ARENA_MAX байт
+#define CLASSES (PAGE_SHIFT - MIN_SHIFT + 1)
+
+#define MAP_BITS (48 - SEG_SHIFT) // Адреси користувацького простору -- 48 біт
+#define MAP_LEAF_BITS 13
+#define MAP_LEAF_WORDS (((size_t) 1 << MAP_LEAF_BITS) / 64)
+
+typedef struct block {
+	struct block *next;
+} block_t;
+
+//! Купа одного потоку. Списки вільних блоків і поточні сторінки чіпає
+//! лише власник; remote -- стек, куди інші потоки кладуть звільнені блоки.
+typedef struct heap {
+	block_t *free[CLASSES];
+	char *bump[CLASSES]; // Ще не нарізана частина сторінки класу
+	char *bump_end[CLASSES];
+	struct segment *seg; // Сегмент, з якого беруться нові сторінки
+	size_t next_page;
+	struct heap *next; // У списку покинутих куп
+	block_t *remote __attribute__((aligned(64))); // Окрема кеш-лінія для чужих потоків
+} heap_t;
+
+//! Заголовок займає сторінку 0 сегмента.
+typedef struct segment {
+	heap_t *heap; // Власник, не змінюється
+	unsigned char page_class[PAGES];
+} segment_t;
+
+// Дворівнева бітова карта сегментів: чи належить адреса арені.
+// Сегменти не повертаються системі, тож біти лише встановлюються.
+static uint64_t *seg_map[(size_t) 1 << (MAP_BITS - MAP_LEAF_BITS)];
+
+static __thread heap_t *tls_heap;
+static pthread_key_t heap_key;
+static pthread_once_t heap_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t abandoned_lock = PTHREAD_MUTEX_INITIALIZER;
+static heap_t *abandoned;
+
+//!===========================================================================
+//! Сегменти
+//!===========================================================================
+
+static int seg_map_set(uintptr_t addr) {
+	size_t index = addr >> SEG_SHIFT;
+	uint64_t **slot = &seg_map[index >> MAP_LEAF_BITS];
+	uint64_t *leaf = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+	if (leaf == NULL) {
+		uint64_t *fresh = calloc(MAP_LEAF_WORDS, sizeof(uint64_t));
+		if (fresh == NULL) {
+			return -2;
+		}
+		if (__atomic_compare_exchange_n(slot, &leaf, fresh, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			leaf = fresh;
+		} else {
+			free(fresh);
+		}
+	}
+	size_t bit = index & (((size_t) 1 << MAP_LEAF_BITS) - 1);
+	__atomic_fetch_or(&leaf[bit / 64], (uint64_t) 1 << (bit % 64), __ATOMIC_RELEASE);
+	return 0;
+}
+
+//! Чи виділено ptr з арени (будь-якого потоку).
+//! Для NULL і пам'яті з malloc() -- 0.
+int my_str_arena_owns(const void *ptr) {
+	uintptr_t addr = (uintptr_t) ptr;
+	if (ptr == NULL || (addr >> 48) != 0) {
+		return 0;
+	}
+	size_t index = addr >> SEG_SHIFT;
+	const uint64_t *leaf = __atomic_load_n(&seg_map[index >> MAP_LEAF_BITS], __ATOMIC_ACQUIRE);
+	if (leaf == NULL) {
+		return 0;
+	}
+	size_t bit = index & (((size_t) 1 << MAP_LEAF_BITS) - 1);
+	return (__atomic_load_n(&leaf[bit / 64], __ATOMIC_ACQUIRE) >> (bit % 64)) & 1;
+}
+
+static segment_t *segment_of(const void *ptr) {
+	return (segment_t *) ((uintptr_t) ptr & ~(uintptr_t) (SEG_SIZE - 1));
+}
+
+static size_t class_of(const void *ptr) {
+	segment_t *seg = segment_of(ptr);
+	return seg->page_class[((uintptr_t) ptr - (uintptr_t) seg) >> PAGE_SHIFT];
+}
+
+static segment_t *segment_new(heap_t *heap) {
+	segment_t *seg = aligned_alloc(SEG_SIZE, SEG_SIZE);
+	if (seg == NULL) {
+		return NULL;
+	}
+	if (seg_map_set((uintptr_t) seg) != 0) {
+		free(seg);
+		return NULL;
+	}
+	seg->heap = heap;
+	memset(seg->page_class, 0, sizeof(seg->page_class));
+	return seg;
+}
+
+//!===========================================================================
+//! Купи потоків
+//!===========================================================================
+
+//! Потік завершився: його купа чекає на новий потік разом з усіма
+//! сегментами. Блоки, які ще живуть, звільняються в її чергу, як і раніше.
+static void heap_abandon(void *raw) {
+	heap_t *heap = raw;
+	tls_heap = NULL;
+	pthread_mutex_lock(&abandoned_lock);
+	heap->next = abandoned;
+	abandoned = heap;
+	pthread_mutex_unlock(&abandoned_lock);
+}
+
+static void heap_key_init(void) {
+	pthread_key_create(&heap_key, heap_abandon);
+}
+
+//! Купа поточного потоку: спершу -- покинута іншим потоком, інакше нова.
+static heap_t *heap_get(void) {
+	heap_t *heap = tls_heap;
+	if (heap != NULL) {
+		return heap;
+	}
+	pthread_once(&heap_once, heap_key_init);
+	pthread_mutex_lock(&abandoned_lock);
+	heap = abandoned;
+	if (heap != NULL) {
+		abandoned = heap->next;
+	}
+	pthread_mutex_unlock(&abandoned_lock);
+	if (heap == NULL) {
+		if ((heap = aligned_alloc(64, sizeof(heap_t))) == NULL) {
+			return NULL;
+		}
+		memset(heap, 0, sizeof(heap_t));
+	}
+	heap->next = NULL;
+	if (pthread_setspecific(heap_key, heap) != 0) {
+		heap_abandon(heap);
+		return NULL;
+	}
+	tls_heap = heap;
+	return heap;
+}
+
+//! Забрати всі віддалено звільнені блоки у свої списки.
+static int heap_drain(heap_t *heap) {
+	if (__atomic_load_n(&heap->remote, __ATOMIC_RELAXED) == NULL) {
+		return 0;
+	}
+	block_t *b = __atomic_exchange_n(&heap->remote, NULL, __ATOMIC_ACQUIRE);
+	while (b != NULL) {
+		block_t *next = b->next;
+		size_t c = class_of(b);
+		b->next = heap->free[c];
+		heap->free[c] = b;
+		b = next;
+	}
+	return 1;
+}
+
+//! Нова сторінка для класу c, за потреби -- з нового сегмента.
+static int heap_page(heap_t *heap, size_t c) {
+	if (heap->seg == NULL || heap->next_page == PAGES) {
+		segment_t *seg = segment_new(heap);
+		if (seg == NULL) {
+			return -2;
+		}
+		heap->seg = seg;
+		heap->next_page = 1;
+	}
+	size_t page = heap->next_page++;
+	heap->seg->page_class[page] = (unsigned char) c;
+	heap->bump[c] = (char *) heap->seg + (page << PAGE_SHIFT);
+	heap->bump_end[c] = heap->bump[c] + ((size_t) 1 << PAGE_SHIFT);
+	return 0;
+}
+
+//!===========================================================================
+//! Виділення і звільнення
+//!===========================================================================
+
+//! Виділити size байт з арени поточного потоку (вирівнювання -- 16 байт).
+//! Блоки до MY_STR_ARENA_MAX беруться з класів-степенів двійки: спершу
+//! зі своїх вільних, потім із повернених іншими потоками, потім нарізаються
+//! з нової сторінки. Більші -- malloc(). NULL -- не вдалося виділити пам'ять.
+//! Звільняти -- my_str_arena_free() у будь-якому потоці.
+void *my_str_arena_alloc(size_t size) {
+	if (size > MY_STR_ARENA_MAX) {
+		return malloc(size);
+	}
+	heap_t *heap = heap_get();
+	if (heap == NULL) {
+		return NULL;
+	}
+	size_t c = size <= ((size_t) 1 << MIN_SHIFT) ? 0 : (size_t) (64 - __builtin_clzll(size - 1)) - MIN_SHIFT;
+	block_t *b = heap->free[c];
+	if (b == NULL && heap_drain(heap)) {
+		b = heap->free[c];
+	}
+	if (b != NULL) {
+		heap->free[c] = b->next;
+		return b;
+	}
+	if (heap->bump[c] == heap->bump_end[c] && heap_page(heap, c) != 0) {
+		return NULL;
+	}
+	b = (block_t *) heap->bump[c];
+	heap->bump[c] += (size_t) 1 << (c + MIN_SHIFT);
+	return b;
+}
+
+//! Звільнити блок, виділений my_str_arena_alloc(), у будь-якому потоці.
+//! Свій блок одразу стає вільним; чужий кладеться у чергу купи-власника
+//! без блокувань і повертається у її списки, коли власнику забракне блоків.
+//! Пам'ять не з арени віддається free(), тож сюди можна передати будь-який
+//! буфер з malloc(). NULL ігнорується.
+void my_str_arena_free(void *ptr) {
+	if (!my_str_arena_owns(ptr)) {
+		free(ptr);
+		return;
+	}
+	block_t *b = ptr;
+	heap_t *owner = segment_of(ptr)->heap;
+	if (owner == tls_heap) {
+		size_t c = class_of(ptr);
+		b->next = owner->free[c];
+		owner->free[c] = b;
+		return;
+	}
+	b->next = __atomic_load_n(&owner->remote, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&owner->remote, &b->next, b, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+	}
+}
+
+//! Одразу забрати блоки, звільнені іншими потоками, у списки поточного
+//! (інакше це стається, коли потоку забракне вільних блоків класу).
+void my_str_arena_collect(void) {
+	if (tls_heap != NULL) {
+		heap_drain(tls_heap);
+	}
+}
@@ -0,0 +1,15 @@
+#ifndef STRLIB_ARENA_H
+#define STRLIB_ARENA_H
+#include <stddef.h>
+
+//! Найбільший блок, що береться з арени; більші виділяє malloc().
+#define MY_STR_ARENA_MAX (64u << 10)
+
+//! Арени потоків для буферів стрічок. Кожен потік виділяє зі своєї
+//! арени без блокувань; блок можна звільнити в будь-якому потоці --
+//! чужий блок повертається власнику через його чергу віддалених звільнень.
+void* my_str_arena_alloc(size_t size);
+void my_str_arena_free(void* ptr);
+int my_str_arena_owns(const void* ptr);
+void my_str_arena_collect(void);
+#endif //STRLIB_ARENA_H
@@ -0,0 +1,146 @@
+//
+// Пакетні операції над масивами стрічок на потоках пулу.
+//
+#include <string.h>
+#include "str_batch.h"
+
+//! Одна пакетна операція: вхід -- масив my_str_t або my_str_vec_t,
+//! op обробляє i-ту стрічку.
+typedef struct batch batch_t;
+struct batch {
+	const my_str_t *strs;
+	const my_str_t *strs2;
+	const my_str_vec_t *vec;
+	my_str_view_t arg;
+	void *out;
+	my_str_transform_fn fn;
+	void *ctx;
+	int failed;
+	void (*op)(batch_t *b, size_t i, my_str_view_t str);
+};
+
+static my_str_view_t batch_get(const batch_t *b, size_t i) {
+	return b->vec ? my_str_vec_get(b->vec, i) : my_str_view(&b->strs[i]);
+}
+
+static void batch_task(size_t index, size_t worker, void *arg) {
+	(void) worker;
+	batch_t *b = arg;
+	b->op(b, index, batch_get(b, index));
+}
+
+//! Без пулу -- у потоці, що викликає.
+static int batch_run(my_str_pool_t *pool, batch_t *b, size_t count) {
+	if (pool == NULL) {
+		for (size_t i = 0; i < count; i++) {
+			batch_task(i, 0, b);
+		}
+		return 0;
+	}
+	return my_str_pool_run(pool, count, batch_task, b);
+}
+
+//! Лексикографічне порівняння, як у my_str_sort() (memcmp, коротший
+//! префікс -- раніше): -1, 0 або 1.
+static int view_cmp(my_str_view_t a, my_str_view_t b) {
+	size_t len = a.size_m < b.size_m ? a.size_m : b.size_m;
+	int r = len ? memcmp(a.data, b.data, len) : 0;
+	if (r != 0) {
+		return r < 0 ? -1 : 1;
+	}
+	return (a.size_m > b.size_m) - (a.size_m < b.size_m);
+}
+
+static void op_find(batch_t *b, size_t i, my_str_view_t str) {
+	((size_t *) b->out)[i] = my_str_view_find(str, b->arg, 0);
+}
+
+static void op_hash(batch_t *b, size_t i, my_str_view_t str) {
+	((uint64_t *) b->out)[i] = my_str_hash(str);
+}
+
+static void op_cmp_pair(batch_t *b, size_t i, my_str_view_t str) {
+	((int *) b->out)[i] = view_cmp(str, my_str_view(&b->strs2[i]));
+}
+
+static void op_cmp_one(batch_t *b, size_t i, my_str_view_t str) {
+	((int *) b->out)[i] = view_cmp(str, b->arg);
+}
+
+static void op_transform(batch_t *b, size_t i, my_str_view_t str) {
+	(void) str;
+	if (b->fn((my_str_t *) &b->strs[i], i, b->ctx) != 0) {
+		__atomic_store_n(&b->failed, 1, __ATOMIC_RELAXED);
+	}
+}
+
+//! results[i] -- перше входження tofind у strs[i] (як my_str_find() з 0),
+//! (size_t)-1 -- немає. pool -- NULL, щоб рахувати в потоці, що викликає.
+//! -1 -- нульовий вказівник, 0 -- все ОК.
+int my_str_batch_find(my_str_pool_t *pool, const my_str_t *strs, size_t count, my_str_view_t tofind, size_t *results) {
+	if ((strs == NULL || results == NULL) && count > 0) {
+		return -1;
+	}
+	batch_t b = {.strs = strs, .arg = tofind, .out = results, .op = op_find};
+	return batch_run(pool, &b, count);
+}
+
+//! hashes[i] = my_str_hash(strs[i]).
+//! -1 -- нульовий вказівник, 0 -- все ОК.
+int my_str_batch_hash(my_str_pool_t *pool, const my_str_t *strs, size_t count, uint64_t *hashes) {
+	if ((strs == NULL || hashes == NULL) && count > 0) {
+		return -1;
+	}
+	batch_t b = {.strs = strs, .out = hashes, .op = op_hash};
+	return batch_run(pool, &b, count);
+}
+
+//! results[i] -- порівняння strs1[i] з strs2[i]: -1, 0 або 1, лексикографічно
+//! (на відміну від my_str_cmp(), що спершу порівнює довжини).
+//! -1 -- нульовий вказівник, 0 -- все ОК.
+int my_str_batch_cmp(my_str_pool_t *pool, const my_str_t *strs1, const my_str_t *strs2, size_t count, int *results) {
+	if ((strs1 == NULL || strs2 == NULL || results == NULL) && count > 0) {
+		return -1;
+	}
+	batch_t b = {.strs = strs1, .strs2 = strs2, .out = results, .op = op_cmp_pair};
+	return batch_run(pool, &b, count);
+}
+
+//! Викликати fn(&strs[i], i, ctx) для кожної стрічки. fn для різних i
+//! працюють одночасно, тож спільний ctx -- лише для читання чи атомарних змін.
+//! -1 -- нульовий вказівник, -4 -- fn повернула помилку хоч раз, 0 -- все ОК.
+int my_str_batch_transform(my_str_pool_t *pool, my_str_t *strs, size_t count, my_str_transform_fn fn, void *ctx) {
+	if (fn == NULL || (strs == NULL && count > 0)) {
+		return -1;
+	}
+	batch_t b = {.strs = strs, .fn = fn, .ctx = ctx, .op = op_transform};
+	int rc = batch_run(pool, &b, count);
+	return rc != 0 ? rc : (b.failed ? -4 : 0);
+}
+
+//! my_str_batch_find() для стрічок масиву (results -- на my_str_vec_size()).
+int my_str_vec_batch_find(my_str_pool_t *pool, const my_str_vec_t *vec, my_str_view_t tofind, size_t *results) {
+	if (vec == NULL || results == NULL) {
+		return -1;
+	}
+	batch_t b = {.vec = vec, .arg = tofind, .out = results, .op = op_find};
+	return batch_run(pool, &b, vec->size_m);
+}
+
+//! my_str_batch_hash() для стрічок масиву.
+int my_str_vec_batch_hash(my_str_pool_t *pool, const my_str_vec_t *vec, uint64_t *hashes) {
+	if (vec == NULL || hashes == NULL) {
+		return -1;
+	}
+	batch_t b = {.vec = vec, .out = hashes, .op = op_hash};
+	return batch_run(pool, &b, vec->size_m);
+}
+
+//! results[i] -- порівняння i-ї стрічки масиву з str, як у my_str_batch_cmp().
+int my_str_vec_batch_cmp(my_str_pool_t *pool, const my_str_vec_t *vec, my_str_view_t str, int *results) {
+	if (vec == NULL || results == NULL) {
+		return -1;
+	}
+	batch_t b = {.vec = vec, .arg = str, .out = results, .op = op_cmp_one};
+	return batch_run(pool, &b, vec->size_m);
+}
@@ -0,0 +1,20 @@
+#ifndef STRLIB_BATCH_H
+#define STRLIB_BATCH_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+#include "str_vec.h"
+#include "str_parallel.h"
+
+//! Перетворення однієї стрічки для my_str_batch_transform(): 0 -- успіх.
+typedef int (*my_str_transform_fn)(my_str_t* str, size_t index, void* ctx);
+
+int my_str_batch_find(my_str_pool_t* pool, const my_str_t* strs, size_t count, my_str_view_t tofind, size_t* results);
+int my_str_batch_hash(my_str_pool_t* pool, const my_str_t* strs, size_t count, uint64_t* hashes);
+int my_str_batch_cmp(my_str_pool_t* pool, const my_str_t* strs1, const my_str_t* strs2, size_t count, int* results);
+int my_str_batch_transform(my_str_pool_t* pool, my_str_t* strs, size_t count, my_str_transform_fn fn, void* ctx);
+int my_str_vec_batch_find(my_str_pool_t* pool, const my_str_vec_t* vec, my_str_view_t tofind, size_t* results);
+int my_str_vec_batch_hash(my_str_pool_t* pool, const my_str_vec_t* vec, uint64_t* hashes);
+int my_str_vec_batch_cmp(my_str_pool_t* pool, const my_str_vec_t* vec, my_str_view_t str, int* results);
+#endif //STRLIB_BATCH_H
@@ -0,0 +1,239 @@
+//
+// Паралельне складання стрічки з фрагментів: смуга на потік, одне виділення в кінці.
+//
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "str_builder.h"
+
+#define CHUNK_MIN (4u << 10)
+#define CHUNK_MAX (1u << 20)
+#define PAR_MIN (1u << 20) // Менше за стільки байт копіюється в одному потоці
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+//! Створити будівник на lanes смуг (зазвичай my_str_pool_threads()).
+//! Після використання -- викличте my_str_builder_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_builder_create(my_str_builder_t *builder, size_t lanes) {
+	if (builder == NULL || lanes == 0) {
+		return -1;
+	}
+	builder->lanes = aligned_alloc(64, sizeof(my_str_builder_lane_t) * lanes);
+	if (builder->lanes == NULL) {
+		return -2;
+	}
+	memset(builder->lanes, 0, sizeof(my_str_builder_lane_t) * lanes);
+	builder->nlanes = lanes;
+	return 0;
+}
+
+//! Звільнити всі блоки, смуги лишаються порожніми.
+void my_str_builder_clear(my_str_builder_t *builder) {
+	if (builder == NULL || builder->lanes == NULL) {
+		return;
+	}
+	for (size_t l = 0; l < builder->nlanes; l++) {
+		my_str_builder_lane_t *lane = &builder->lanes[l];
+		for (my_str_builder_chunk_t *c = lane->head; c != NULL;) {
+			my_str_builder_chunk_t *next = c->next;
+			free(c);
+			c = next;
+		}
+		lane->head = NULL;
+		lane->tail = NULL;
+		lane->size_m = 0;
+		lane->chunks = 0;
+	}
+}
+
+void my_str_builder_free(my_str_builder_t *builder) {
+	if (builder == NULL) {
+		return;
+	}
+	my_str_builder_clear(builder);
+	free(builder->lanes);
+	builder->lanes = NULL;
+	builder->nlanes = 0;
+}
+
+//! Дописати копію str у смугу lane. Одну смугу одночасно може
+//! доповнювати лише один потік; різні смуги -- без жодної синхронізації.
+//! Блоки смуги ростуть удвічі (4 КіБ .. 1 МіБ), дані не переміщуються.
+//! -1 -- нульовий вказівник чи смуга за межами, -2 -- не вдалося виділити пам'ять.
+int my_str_builder_append(my_str_builder_t *builder, size_t lane, my_str_view_t str) {
+	if (builder == NULL || lane >= builder->nlanes || (str.data == NULL && str.size_m > 0)) {
+		return -1;
+	}
+	my_str_builder_lane_t *l = &builder->lanes[lane];
+	my_str_builder_chunk_t *tail = l->tail;
+	if (tail == NULL || tail->capacity_m - tail->size_m < str.size_m) {
+		size_t cap = tail ? tail->capacity_m * 2 : CHUNK_MIN;
+		if (cap > CHUNK_MAX) {
+			cap = CHUNK_MAX;
+		}
+		if (cap < str.size_m) {
+			cap = str.size_m;
+		}
+		my_str_builder_chunk_t *c = malloc(sizeof(*c) + cap);
+		if (c == NULL) {
+			return -2;
+		}
+		c->next = NULL;
+		c->size_m = 0;
+		c->capacity_m = cap;
+		if (tail != NULL) {
+			tail->next = c;
+		} else {
+			l->head = c;
+		}
+		l->tail = c;
+		l->chunks++;
+		tail = c;
+	}
+	if (str.size_m > 0) {
+		memcpy(tail->data + tail->size_m, str.data, str.size_m);
+	}
+	tail->size_m += str.size_m;
+	l->size_m += str.size_m;
+	return 0;
+}
+
+//! my_str_builder_append() для my_str_t.
+int my_str_builder_append_str(my_str_builder_t *builder, size_t lane, const my_str_t *str) {
+	if (str == NULL) {
+		return -1;
+	}
+	return my_str_builder_append(builder, lane, my_str_view(str));
+}
+
+//! Загальний розмір усіх смуг.
+size_t my_str_builder_size(const my_str_builder_t *builder) {
+	size_t size = 0;
+	for (size_t l = 0; builder != NULL && l < builder->nlanes; l++) {
+		size += builder->lanes[l].size_m;
+	}
+	return size;
+}
+
+//! Блоки в порядку результату і місце кожного в ньому.
+typedef struct {
+	const my_str_builder_chunk_t **chunks;
+	size_t *offsets;
+	char *dest;
+} gather_t;
+
+static void copy_chunk(size_t index, size_t worker, void *arg) {
+	(void) worker;
+	gather_t *g = arg;
+	memcpy(g->dest + g->offsets[index], g->chunks[index]->data, g->chunks[index]->size_m);
+}
+
+//! Зібрати весь вміст у out одним виділенням (out має бути створена;
+//! старий вміст замінюється). З пулом великі результати копіюються
+//! блоками паралельно. Будівник не змінюється.
+//! Не можна викликати, поки інші потоки ще дописують.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_builder_finish(const my_str_builder_t *builder, my_str_t *out, my_str_pool_t *pool) {
+	if (builder == NULL || out == NULL) {
+		return -1;
+	}
+	size_t total = my_str_builder_size(builder);
+	if (total > out->capacity_m && (my_str_reserve(out, total) != 0 || out->data == NULL)) {
+		return -2;
+	}
+	if (pool == NULL || total < PAR_MIN) {
+		size_t off = 0;
+		for (size_t l = 0; l < builder->nlanes; l++) {
+			for (const my_str_builder_chunk_t *c = builder->lanes[l].head; c != NULL; c = c->next) {
+				memcpy(out->data + off, c->data, c->size_m);
+				off += c->size_m;
+			}
+		}
+		out->size_m = total;
+		return 0;
+	}
+	size_t count = 0;
+	for (size_t l = 0; l < builder->nlanes; l++) {
+		count += builder->lanes[l].chunks;
+	}
+	gather_t g = {malloc(sizeof(*g.chunks) * count), malloc(sizeof(size_t) * count), out->data};
+	if (g.chunks == NULL || g.offsets == NULL) {
+		free(g.chunks);
+		free(g.offsets);
+		return -2;
+	}
+	size_t i = 0;
+	size_t off = 0;
+	for (size_t l = 0; l < builder->nlanes; l++) {
+		for (const my_str_builder_chunk_t *c = builder->lanes[l].head; c != NULL; c = c->next) {
+			g.chunks[i] = c;
+			g.offsets[i++] = off;
+			off += c->size_m;
+		}
+	}
+	my_str_pool_run(pool, count, copy_chunk, &g);
+	out->size_m = total;
+	free(g.chunks);
+	free(g.offsets);
+	return 0;
+}
+
+//! Записати весь вміст у fd без складання в одну стрічку: блоки йдуть
+//! прямо з пам'яті, до IOV_MAX за один writev(). Часткові записи
+//! дописуються. Будівник не змінюється.
+//! -1 -- нульовий вказівник, -3 -- помилка запису, 0 -- все ОК.
+int my_str_builder_writev(const my_str_builder_t *builder, int fd) {
+	if (builder == NULL) {
+		return -1;
+	}
+	struct iovec iov[IOV_MAX];
+	size_t l = 0;
+	const my_str_builder_chunk_t *c = builder->nlanes ? builder->lanes[0].head : NULL;
+	for (;;) {
+		int n = 0;
+		while (n < IOV_MAX) {
+			while (c == NULL && ++l < builder->nlanes) {
+				c = builder->lanes[l].head;
+			}
+			if (c == NULL) {
+				break;
+			}
+			if (c->size_m > 0) {
+				iov[n].iov_base = (void *) c->data;
+				iov[n].iov_len = c->size_m;
+				n++;
+			}
+			c = c->next;
+		}
+		if (n == 0) {
+			return 0;
+		}
+		struct iovec *v = iov;
+		while (n > 0) {
+			ssize_t done = writev(fd, v, n);
+			if (done < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return -3;
+			}
+			// Пропустити записане повністю, решту першого -- зсунути.
+			while (n > 0 && (size_t) done >= v->iov_len) {
+				done -= (ssize_t) v->iov_len;
+				v++;
+				n--;
+			}
+			if (n > 0) {
+				v->iov_base = (char *) v->iov_base + done;
+				v->iov_len -= (size_t) done;
+			}
+		}
+	}
+}
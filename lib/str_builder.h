@@ -0,0 +1,44 @@
+#ifndef STRLIB_BUILDER_H
+#define STRLIB_BUILDER_H
+#include <stdio.h>
+#include "stringg.h"
+#include "str_view.h"
+#include "str_parallel.h"
+
+//! Блок фрагментів однієї смуги.
+typedef struct my_str_builder_chunk
+{
+	struct my_str_builder_chunk* next;
+	size_t size_m;
+	size_t capacity_m;
+	char data[];
+} my_str_builder_chunk_t;
+
+//! Смуга одного потоку: лише свої блоки, на своїй кеш-лінії.
+typedef struct
+{
+	my_str_builder_chunk_t* head;
+	my_str_builder_chunk_t* tail;
+	size_t size_m;	 // Байт у смузі
+	size_t chunks;	 // Блоків у смузі
+	char pad[64 - 2 * sizeof(void*) - 2 * sizeof(size_t)];
+} my_str_builder_lane_t;
+
+//! Паралельний будівник стрічки: кожен потік дописує у свою смугу
+//! (номер -- як worker у my_str_pool_run()), без спільних даних.
+//! Результат -- смуга 0, потім 1 і т. д., у кожній -- в порядку дописування.
+typedef struct
+{
+	my_str_builder_lane_t* lanes;
+	size_t nlanes;
+} my_str_builder_t;
+
+int my_str_builder_create(my_str_builder_t* builder, size_t lanes);
+void my_str_builder_free(my_str_builder_t* builder);
+void my_str_builder_clear(my_str_builder_t* builder);
+int my_str_builder_append(my_str_builder_t* builder, size_t lane, my_str_view_t str);
+int my_str_builder_append_str(my_str_builder_t* builder, size_t lane, const my_str_t* str);
+size_t my_str_builder_size(const my_str_builder_t* builder);
+int my_str_builder_finish(const my_str_builder_t* builder, my_str_t* out, my_str_pool_t* pool);
+int my_str_builder_writev(const my_str_builder_t* builder, int fd);
+#endif //STRLIB_BUILDER_H
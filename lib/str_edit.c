@@ -0,0 +1,178 @@
+//
+// Відстань Левенштейна: бітово-паралельний алгоритм Маєрса (з блоками Хюрьо).
+//
+#include <stdlib.h>
+#include <string.h>
+#include "str_edit.h"
+
+//! Зразок, підготовлений до порівнянь: для кожного байта -- маска його позицій.
+typedef struct {
+	size_t size_m;
+	size_t blocks;	// Скільки 64-бітних слів займає стовпчик
+	uint64_t *peq;	// peq[c * blocks + b]
+	uint64_t *pv;	// Вертикальні різниці +1 / -1 поточного стовпчика
+	uint64_t *mv;
+	uint64_t local[256 + 2]; // Місце для зразків до 64 символів -- без malloc()
+} pattern_t;
+
+static int pattern_init(pattern_t *p, my_str_view_t pat) {
+	p->size_m = pat.size_m;
+	p->blocks = (pat.size_m + 63) / 64;
+	if (p->blocks <= 1) {
+		p->peq = p->local;
+	} else {
+		p->peq = malloc(sizeof(uint64_t) * (256 + 2) * p->blocks);
+		if (p->peq == NULL) {
+			return -2;
+		}
+	}
+	p->pv = p->peq + 256 * p->blocks;
+	p->mv = p->pv + p->blocks;
+	memset(p->peq, 0, sizeof(uint64_t) * 256 * p->blocks);
+	for (size_t i = 0; i < pat.size_m; i++) {
+		p->peq[(unsigned char) pat.data[i] * p->blocks + i / 64] |= 1ull << (i % 64);
+	}
+	return 0;
+}
+
+static void pattern_free(pattern_t *p) {
+	if (p->peq != p->local) {
+		free(p->peq);
+	}
+}
+
+//! Один стовпчик одного блоку. hin -- горизонтальна різниця над блоком
+//! (-1, 0, +1), повертає різницю під ним.
+static inline int block_step(uint64_t *pv, uint64_t *mv, uint64_t eq, int hin, uint64_t *ph_out, uint64_t *mh_out) {
+	uint64_t hin_neg = hin < 0;
+	uint64_t xv = eq | *mv;
+	eq |= hin_neg;
+	uint64_t xh = (((eq & *pv) + *pv) ^ *pv) | eq;
+	uint64_t ph = *mv | ~(xh | *pv);
+	uint64_t mh = *pv & xh;
+	int hout = (int) (ph >> 63) - (int) (mh >> 63);
+	*ph_out = ph;
+	*mh_out = mh;
+	ph = (ph << 1) | (uint64_t) (hin > 0);
+	mh = (mh << 1) | hin_neg;
+	*pv = mh | ~(xv | ph);
+	*mv = ph & xv;
+	return hout;
+}
+
+//! Відстань від зразка до text, або max + 1, якщо вона більша за max.
+static size_t myers(pattern_t *p, my_str_view_t text, size_t max) {
+	size_t m = p->size_m;
+	size_t n = text.size_m;
+	if ((m > n ? m - n : n - m) > max) {
+		return max + 1;
+	}
+	if (m == 0) {
+		return n;
+	}
+	size_t blocks = p->blocks;
+	size_t last = blocks - 1;
+	uint64_t last_bit = 1ull << ((m - 1) % 64);
+	for (size_t b = 0; b < blocks; b++) {
+		p->pv[b] = ~0ull;
+		p->mv[b] = 0;
+	}
+	size_t score = m;
+	for (size_t j = 0; j < n; j++) {
+		const uint64_t *eq = p->peq + (unsigned char) text.data[j] * blocks;
+		uint64_t ph;
+		uint64_t mh;
+		// Верхній рядок D[0][j] = j -- згори завжди +1.
+		int h = 1;
+		for (size_t b = 0; b < last; b++) {
+			h = block_step(p->pv + b, p->mv + b, eq[b], h, &ph, &mh);
+		}
+		block_step(p->pv + last, p->mv + last, eq[last], h, &ph, &mh);
+		// Останній рядок зразка може бути й посередині слова.
+		score += (ph & last_bit) != 0;
+		score -= (mh & last_bit) != 0;
+		// Кожен наступний стовпчик зменшує відстань щонайбільше на 1.
+		if (score > max && score - max > n - 1 - j) {
+			return max + 1;
+		}
+	}
+	return score;
+}
+
+//! Спільний початок і кінець на відстань не впливають -- відкидаємо їх,
+//! а зразком робимо коротшу стрічку: менше блоків на стовпчик.
+static size_t distance(my_str_view_t a, my_str_view_t b, size_t max) {
+	while (a.size_m > 0 && b.size_m > 0 && a.data[0] == b.data[0]) {
+		a.data++;
+		b.data++;
+		a.size_m--;
+		b.size_m--;
+	}
+	while (a.size_m > 0 && b.size_m > 0 && a.data[a.size_m - 1] == b.data[b.size_m - 1]) {
+		a.size_m--;
+		b.size_m--;
+	}
+	if (a.size_m > b.size_m) {
+		my_str_view_t t = a;
+		a = b;
+		b = t;
+	}
+	if (b.size_m - a.size_m > max) {
+		return max + 1;
+	}
+	if (a.size_m == 0) {
+		return b.size_m;
+	}
+	pattern_t p;
+	if (pattern_init(&p, a) != 0) {
+		return MY_STR_EDIT_FAILED;
+	}
+	size_t dist = myers(&p, b, max);
+	pattern_free(&p);
+	return dist;
+}
+
+//! Відстань Левенштейна (вставка, видалення, заміна байта -- по 1).
+//! O(n * m / 64). MY_STR_EDIT_FAILED -- не вдалося виділити пам'ять.
+size_t my_str_view_edit_distance(my_str_view_t a, my_str_view_t b) {
+	return distance(a, b, SIZE_MAX - 2);
+}
+
+//! Те саме, але з раннім виходом: якщо відстань більша за max --
+//! повертає max + 1, щойно це стане зрозуміло.
+size_t my_str_view_edit_distance_max(my_str_view_t a, my_str_view_t b, size_t max) {
+	if (max >= SIZE_MAX - 1) {
+		max = SIZE_MAX - 2;
+	}
+	return distance(a, b, max);
+}
+
+size_t my_str_edit_distance(const my_str_t *str1, const my_str_t *str2) {
+	return my_str_view_edit_distance(my_str_view(str1), my_str_view(str2));
+}
+
+size_t my_str_edit_distance_max(const my_str_t *str1, const my_str_t *str2, size_t max) {
+	return my_str_view_edit_distance_max(my_str_view(str1), my_str_view(str2), max);
+}
+
+//! Відстані від query до кожної стрічки масиву в dist (розміру
+//! my_str_vec_size()). Більші за max -- записуються як max + 1;
+//! max = SIZE_MAX -- без обмеження. Маски query готуються один раз.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_vec_edit_distance(const my_str_vec_t *vec, my_str_view_t query, size_t max, size_t *dist) {
+	if (vec == NULL || dist == NULL || (query.data == NULL && query.size_m > 0)) {
+		return -1;
+	}
+	if (max >= SIZE_MAX - 1) {
+		max = SIZE_MAX - 2;
+	}
+	pattern_t p;
+	if (pattern_init(&p, query) != 0) {
+		return -2;
+	}
+	for (size_t i = 0; i < vec->size_m; i++) {
+		dist[i] = myers(&p, my_str_vec_get(vec, i), max);
+	}
+	pattern_free(&p);
+	return 0;
+}
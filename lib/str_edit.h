@@ -0,0 +1,16 @@
+#ifndef STRLIB_EDIT_H
+#define STRLIB_EDIT_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+#include "str_vec.h"
+
+#define MY_STR_EDIT_FAILED ((size_t) -1) // Не вдалося виділити пам'ять
+
+size_t my_str_view_edit_distance(my_str_view_t a, my_str_view_t b);
+size_t my_str_view_edit_distance_max(my_str_view_t a, my_str_view_t b, size_t max);
+size_t my_str_edit_distance(const my_str_t* str1, const my_str_t* str2);
+size_t my_str_edit_distance_max(const my_str_t* str1, const my_str_t* str2, size_t max);
+int my_str_vec_edit_distance(const my_str_vec_t* vec, my_str_view_t query, size_t max, size_t* dist);
+#endif //STRLIB_EDIT_H
@@ -0,0 +1,392 @@
+//
+// Зовнішнє сортування записів (з усуненням повторів і підрахунком) для файлів,
+// більших за пам'ять.
+//
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "str_extsort.h"
+#include "str_reader.h"
+#include "str_vec.h"
+#include "str_sort.h"
+
+#define OUT_FLUSH (1 << 20)
+#define ENTRY_COST 64 // Оцінка пам'яті на запис поза блоком: таблиця й сортування
+
+//! Запис серії, коли рахуємо: 8 байт кількості (порядок байтів машини), потім сам запис.
+#define COUNT_PREFIX sizeof(uint64_t)
+
+typedef struct {
+	const my_str_extsort_t *opts;
+	size_t prefix;		// COUNT_PREFIX, якщо повтори зливаються, інакше 0
+	int fd_out;
+	my_str_t out;		// Буфер виводу
+	my_str_view_t last; // Останній ще не виведений запис (коли зливаємо повтори)
+	uint64_t count;
+	int have_last;
+	char **paths;		// Тимчасові файли серій
+	size_t nruns;
+	size_t cap_runs;
+} sorter_t;
+
+static int write_all(int fd, const char *data, size_t len) {
+	while (len > 0) {
+		ssize_t n = write(fd, data, len);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -3;
+		}
+		data += n;
+		len -= (size_t) n;
+	}
+	return 0;
+}
+
+static int out_flush(sorter_t *s) {
+	int rc = write_all(s->fd_out, s->out.data, s->out.size_m);
+	s->out.size_m = 0;
+	return rc;
+}
+
+static int out_append(sorter_t *s, const char *data, size_t len) {
+	if (s->out.size_m + len > s->out.capacity_m) {
+		if (s->out.size_m > 0 && out_flush(s) != 0) {
+			return -3;
+		}
+		if (len > s->out.capacity_m) {
+			return write_all(s->fd_out, data, len);
+		}
+	}
+	memcpy(s->out.data + s->out.size_m, data, len);
+	s->out.size_m += len;
+	return 0;
+}
+
+static int out_record(sorter_t *s, my_str_view_t rec, uint64_t count) {
+	if (s->opts->flags & MY_STR_EXTSORT_COUNT) {
+		char num[32];
+		int len = snprintf(num, sizeof(num), "%7llu ", (unsigned long long) count);
+		if (out_append(s, num, (size_t) len) != 0) {
+			return -3;
+		}
+	}
+	if (out_append(s, rec.data, rec.size_m) != 0 || out_append(s, &s->opts->delimiter, 1) != 0) {
+		return -3;
+	}
+	if (s->out.size_m >= OUT_FLUSH) {
+		return out_flush(s);
+	}
+	return 0;
+}
+
+//! Наступний запис злиття: одразу на вихід або, якщо зливаємо повтори,
+//! притримати до першого відмінного. last має жити до наступного виклику.
+static int emit(sorter_t *s, my_str_view_t rec, uint64_t count) {
+	if (s->prefix == 0) {
+		return out_record(s, rec, count);
+	}
+	if (s->have_last && my_str_view_eq(s->last, rec)) {
+		s->count += count;
+		return 0;
+	}
+	int rc = s->have_last ? out_record(s, s->last, s->count) : 0;
+	s->last = rec;
+	s->count = count;
+	s->have_last = 1;
+	return rc;
+}
+
+static int emit_finish(sorter_t *s) {
+	if (s->have_last && out_record(s, s->last, s->count) != 0) {
+		return -3;
+	}
+	s->have_last = 0;
+	return out_flush(s);
+}
+
+//! Запис серії: ключ і кількість.
+static my_str_view_t run_key(const sorter_t *s, my_str_view_t entry, uint64_t *count) {
+	if (s->prefix == 0) {
+		*count = 1;
+		return entry;
+	}
+	memcpy(count, entry.data, COUNT_PREFIX);
+	return my_str_view_sub(entry, COUNT_PREFIX, entry.size_m);
+}
+
+//! Відсортувати накопичену серію і або віддати її одразу (якщо вона
+//! єдина), або записати на диск у форматі my_str_vec_t -- у порядку
+//! сортування, з повторами, вже злитими в один запис із кількістю.
+static int flush_run(sorter_t *s, my_str_vec_t *run, int last) {
+	if (my_str_vec_sort(run, s->opts->pool, MY_STR_SORT_STABLE) != 0) {
+		return -2;
+	}
+	size_t n = my_str_vec_size(run);
+	if (last && s->nruns == 0) {
+		for (size_t i = 0; i < n; i++) {
+			if (emit(s, my_str_vec_get(run, i), 1) != 0) {
+				return -3;
+			}
+		}
+		return emit_finish(s);
+	}
+	if (n == 0) {
+		return 0;
+	}
+	my_str_vec_t spill;
+	if (my_str_vec_create(&spill, n) != 0) {
+		return -2;
+	}
+	my_str_t entry;
+	my_str_create(&entry, 0);
+	int rc = 0;
+	for (size_t i = 0; i < n && rc == 0; i++) {
+		my_str_view_t rec = my_str_vec_get(run, i);
+		if (s->prefix == 0) {
+			rc = my_str_vec_push(&spill, rec);
+			continue;
+		}
+		uint64_t count = 1;
+		while (i + 1 < n && my_str_view_eq(rec, my_str_vec_get(run, i + 1))) {
+			count++;
+			i++;
+		}
+		if (entry.capacity_m < COUNT_PREFIX + rec.size_m + 1) {
+			my_str_reserve(&entry, COUNT_PREFIX + rec.size_m + 1);
+		}
+		if (entry.data == NULL || entry.capacity_m < COUNT_PREFIX + rec.size_m) {
+			rc = -2;
+			break;
+		}
+		memcpy(entry.data, &count, COUNT_PREFIX);
+		memcpy(entry.data + COUNT_PREFIX, rec.data, rec.size_m);
+		entry.size_m = COUNT_PREFIX + rec.size_m;
+		rc = my_str_vec_push(&spill, my_str_view(&entry));
+	}
+	my_str_free(&entry);
+	if (rc != 0) {
+		my_str_vec_free(&spill);
+		return -2;
+	}
+
+	if (s->nruns == s->cap_runs) {
+		size_t cap = s->cap_runs ? s->cap_runs * 2 : 16;
+		char **paths = realloc(s->paths, sizeof(char *) * cap);
+		if (paths == NULL) {
+			my_str_vec_free(&spill);
+			return -2;
+		}
+		s->paths = paths;
+		s->cap_runs = cap;
+	}
+	const char *dir = s->opts->tmp_dir;
+	if (dir == NULL) {
+		dir = getenv("TMPDIR");
+	}
+	if (dir == NULL || *dir == '\0') {
+		dir = "/tmp";
+	}
+	size_t len = strlen(dir) + 32;
+	char *path = malloc(len);
+	int fd = -1;
+	if (path != NULL) {
+		snprintf(path, len, "%s/mystrsort.XXXXXX", dir);
+		fd = mkstemp(path);
+	}
+	if (fd < 0) {
+		free(path);
+		my_str_vec_free(&spill);
+		return -4;
+	}
+	close(fd);
+	s->paths[s->nruns++] = path;
+	rc = my_str_vec_save(&spill, path) == 0 ? 0 : -4;
+	my_str_vec_free(&spill);
+	return rc;
+}
+
+//!===========================================================================
+//! Злиття серій деревом переможених
+//!===========================================================================
+
+typedef struct {
+	my_str_vec_t *runs;
+	size_t *pos;		// Наступний запис кожної серії
+	size_t k;
+	size_t *tree;		// tree[0] -- переможець, tree[1..k) -- переможені у вузлах
+	const sorter_t *s;
+} merge_t;
+
+//! Чи йде поточний запис серії a раніше, ніж серії b. Вичерпана серія --
+//! нескінченність; при рівних ключах раніша серія -- раніше (стабільно).
+static int run_less(const merge_t *m, size_t a, size_t b) {
+	if (m->pos[a] >= my_str_vec_size(&m->runs[a])) {
+		return 0;
+	}
+	if (m->pos[b] >= my_str_vec_size(&m->runs[b])) {
+		return 1;
+	}
+	uint64_t ca;
+	uint64_t cb;
+	my_str_view_t x = run_key(m->s, my_str_vec_get(&m->runs[a], m->pos[a]), &ca);
+	my_str_view_t y = run_key(m->s, my_str_vec_get(&m->runs[b], m->pos[b]), &cb);
+	size_t len = x.size_m < y.size_m ? x.size_m : y.size_m;
+	int r = len ? memcmp(x.data, y.data, len) : 0;
+	if (r != 0) {
+		return r < 0;
+	}
+	if (x.size_m != y.size_m) {
+		return x.size_m < y.size_m;
+	}
+	return a < b;
+}
+
+//! Вузли 1..k-1 -- внутрішні, k..2k-1 -- листки (серії).
+static size_t tree_build(merge_t *m, size_t node) {
+	if (node >= m->k) {
+		return node - m->k;
+	}
+	size_t a = tree_build(m, 2 * node);
+	size_t b = tree_build(m, 2 * node + 1);
+	if (run_less(m, a, b)) {
+		m->tree[node] = b;
+		return a;
+	}
+	m->tree[node] = a;
+	return b;
+}
+
+//! Серія winner зсунулася -- переграти шлях від її листка до кореня.
+static void tree_replay(merge_t *m, size_t winner) {
+	for (size_t t = (winner + m->k) / 2; t >= 1; t /= 2) {
+		if (run_less(m, m->tree[t], winner)) {
+			size_t loser = winner;
+			winner = m->tree[t];
+			m->tree[t] = loser;
+		}
+	}
+	m->tree[0] = winner;
+}
+
+static int merge_runs(sorter_t *s) {
+	size_t k = s->nruns;
+	merge_t m = {calloc(k, sizeof(my_str_vec_t)), calloc(k, sizeof(size_t)), k, calloc(k + 1, sizeof(size_t)), s};
+	int rc = m.runs && m.pos && m.tree ? 0 : -2;
+	size_t loaded = 0;
+	for (; rc == 0 && loaded < k; loaded++) {
+		if (my_str_vec_create(&m.runs[loaded], 0) != 0) {
+			rc = -2;
+			break;
+		}
+		if (my_str_vec_load(&m.runs[loaded], s->paths[loaded], 0) != 0) {
+			loaded++;
+			rc = -4;
+			break;
+		}
+		// Відображення тримає файл, тож ім'я вже не потрібне.
+		unlink(s->paths[loaded]);
+	}
+	if (rc == 0) {
+		m.tree[0] = tree_build(&m, 1);
+		for (;;) {
+			size_t w = m.tree[0];
+			if (m.pos[w] >= my_str_vec_size(&m.runs[w])) {
+				break;
+			}
+			uint64_t count;
+			my_str_view_t rec = run_key(s, my_str_vec_get(&m.runs[w], m.pos[w]), &count);
+			if (emit(s, rec, count) != 0) {
+				rc = -3;
+				break;
+			}
+			m.pos[w]++;
+			tree_replay(&m, w);
+		}
+		if (rc == 0) {
+			rc = emit_finish(s);
+		}
+	}
+	for (size_t i = 0; i < loaded; i++) {
+		my_str_vec_free(&m.runs[i]);
+	}
+	free(m.runs);
+	free(m.pos);
+	free(m.tree);
+	return rc;
+}
+
+//! Відсортувати записи з fd_in (блокуючого; до роздільника opts->delimiter) у fd_out,
+//! як memcmp, коротший префікс -- раніше; однакові -- у порядку надходження.
+//! Поки записи вміщуються в бюджет пам'яті, усе робиться в пам'яті.
+//! Інакше відсортовані серії (до половини бюджету, друга -- на запис серії)
+//! скидаються в тимчасові файли формату my_str_vec_t і зливаються деревом
+//! переможених з відображень. З MY_STR_EXTSORT_UNIQUE/COUNT повтори
+//! зливаються вже в серіях, тож на диск іде лише різне.
+//! Останній запис виходу теж закінчується роздільником.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять,
+//! -3 -- помилка читання чи запису, -4 -- помилка тимчасових файлів, 0 -- все ОК.
+int my_str_extsort(const my_str_extsort_t *opts, int fd_in, int fd_out) {
+	if (opts == NULL) {
+		return -1;
+	}
+	size_t budget = (opts->memory ? opts->memory : MY_STR_EXTSORT_MEMORY) / 2;
+	sorter_t s;
+	memset(&s, 0, sizeof(s));
+	s.opts = opts;
+	s.fd_out = fd_out;
+	s.prefix = opts->flags & (MY_STR_EXTSORT_UNIQUE | MY_STR_EXTSORT_COUNT) ? COUNT_PREFIX : 0;
+	my_str_reader_t reader;
+	my_str_vec_t run;
+	if (my_str_create(&s.out, OUT_FLUSH) != 0) {
+		return -2;
+	}
+	if (my_str_reader_create(&reader, opts->delimiter, 0) != 0) {
+		my_str_free(&s.out);
+		return -2;
+	}
+	if (my_str_vec_create(&run, 0) != 0) {
+		my_str_reader_free(&reader);
+		my_str_free(&s.out);
+		return -2;
+	}
+
+	int rc = 0;
+	int more = 1;
+	while (rc == 0 && more) {
+		int got = my_str_reader_fill(&reader, fd_in);
+		if (got == 0) {
+			more = 0;
+		} else if (got == -2) {
+			rc = -2;
+		} else if (got < 0) {
+			rc = -3;
+		}
+		my_str_view_t rec;
+		while (rc == 0 && my_str_reader_next(&reader, &rec) == 1) {
+			if (my_str_vec_push(&run, rec) != 0) {
+				rc = -2;
+			} else if (run.blob.size_m + my_str_vec_size(&run) * ENTRY_COST >= budget) {
+				rc = flush_run(&s, &run, 0);
+				my_str_vec_clear(&run);
+			}
+		}
+	}
+	if (rc == 0) {
+		rc = flush_run(&s, &run, 1);
+	}
+	my_str_vec_free(&run);
+	my_str_reader_free(&reader);
+	if (rc == 0 && s.nruns > 0) {
+		rc = merge_runs(&s);
+	}
+	for (size_t i = 0; i < s.nruns; i++) {
+		unlink(s.paths[i]);
+		free(s.paths[i]);
+	}
+	free(s.paths);
+	my_str_free(&s.out);
+	return rc;
+}
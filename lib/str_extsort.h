@@ -0,0 +1,24 @@
+#ifndef STRLIB_EXTSORT_H
+#define STRLIB_EXTSORT_H
+#include <stdio.h>
+#include "stringg.h"
+#include "str_view.h"
+#include "str_parallel.h"
+
+#define MY_STR_EXTSORT_UNIQUE 1 // Кожен запис лише раз (sort -u)
+#define MY_STR_EXTSORT_COUNT 2	// Кожен запис лише раз, з кількістю (sort | uniq -c)
+
+#define MY_STR_EXTSORT_MEMORY ((size_t) 256 << 20) // Бюджет пам'яті за замовчуванням
+
+//! Параметри зовнішнього сортування.
+typedef struct
+{
+	size_t memory;		   // Бюджет пам'яті на записи, 0 -- MY_STR_EXTSORT_MEMORY
+	char delimiter;		   // Роздільник записів на вході й виході
+	int flags;
+	const char* tmp_dir;   // Тека для тимчасових серій, NULL -- $TMPDIR або /tmp
+	my_str_pool_t* pool;   // Для сортування серій, NULL -- в одному потоці
+} my_str_extsort_t;
+
+int my_str_extsort(const my_str_extsort_t* opts, int fd_in, int fd_out);
+#endif //STRLIB_EXTSORT_H
@@ -0,0 +1,241 @@
+//
+// Файловий ввід-вивід без посимвольного fgetc().
+//
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#include "str_file.h"
+
+//! Відобразити весь файл у пам'ять лише для читання.
+//! Порожній файл -- не помилка: data == NULL, size_m == 0.
+//! Після використання -- викличте my_str_unmap_file().
+//! -1 -- нульовий вказівник, -2 -- не вдалося відкрити файл,
+//! -3 -- не вдалося відобразити, 0 -- все ОК.
+int my_str_map_file(my_str_map_t *map, const char *path) {
+	if (map == NULL || path == NULL) {
+		return -1;
+	}
+	map->data = NULL;
+	map->size_m = 0;
+	map->fd = open(path, O_RDONLY);
+	if (map->fd < 0) {
+		return -2;
+	}
+	struct stat st;
+	if (fstat(map->fd, &st) != 0) {
+		close(map->fd);
+		map->fd = -1;
+		return -2;
+	}
+	if (st.st_size == 0) {
+		return 0;
+	}
+	void *addr = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, map->fd, 0);
+	if (addr == MAP_FAILED) {
+		close(map->fd);
+		map->fd = -1;
+		return -3;
+	}
+	// Читатимемо послідовно -- хай ядро читає наперед.
+	madvise(addr, (size_t) st.st_size, MADV_SEQUENTIAL);
+	map->data = addr;
+	map->size_m = (size_t) st.st_size;
+	return 0;
+}
+
+//! Зняти відображення та закрити файл.
+void my_str_unmap_file(my_str_map_t *map) {
+	if (map == NULL) {
+		return;
+	}
+	if (map->data != NULL) {
+		munmap((void *) map->data, map->size_m);
+	}
+	if (map->fd >= 0) {
+		close(map->fd);
+	}
+	map->data = NULL;
+	map->size_m = 0;
+	map->fd = -1;
+}
+
+//! Погляд на весь вміст відображеного файлу.
+my_str_view_t my_str_map_view(const my_str_map_t *map) {
+	my_str_view_t view = {map->data, map->size_m};
+	return view;
+}
+
+//!===========================================================================
+//! Атомарна заміна файлу
+//!===========================================================================
+
+//! Почати запис нового вмісту path: у тимчасовий файл поруч (path.tmpXXXXXX),
+//! з правами старого файлу, якщо він є, інакше 0644. Старий файл лишається
+//! цілим, доки my_str_replace_commit() не підмінить його через rename() --
+//! тож і відображення старого файлу в пам'ять живе далі.
+//! *tmp_path -- ім'я тимчасового файлу, його звільнить my_str_replace_commit().
+//! NULL -- не вдалося створити файл.
+FILE *my_str_replace_open(const char *path, char **tmp_path) {
+	size_t len = strlen(path) + sizeof(".tmpXXXXXX");
+	char *tmp = malloc(len);
+	if (tmp == NULL) {
+		return NULL;
+	}
+	snprintf(tmp, len, "%s.tmpXXXXXX", path);
+	int fd = mkstemp(tmp);
+	if (fd < 0) {
+		free(tmp);
+		return NULL;
+	}
+	struct stat st;
+	fchmod(fd, stat(path, &st) == 0 ? st.st_mode & 07777 : 0644);
+	FILE *file = fdopen(fd, "wb");
+	if (file == NULL) {
+		close(fd);
+		unlink(tmp);
+		free(tmp);
+		return NULL;
+	}
+	*tmp_path = tmp;
+	return file;
+}
+
+//! Завершити запис, початий my_str_replace_open(): якщо ok, дописати
+//! на диск (fsync) і підмінити path; інакше -- видалити тимчасовий файл.
+//! -1 -- запис не вдався чи ok == 0 (path не змінено), 0 -- все ОК.
+int my_str_replace_commit(FILE *file, char *tmp_path, const char *path, int ok) {
+	if (ok && (fflush(file) != 0 || fsync(fileno(file)) != 0)) {
+		ok = 0;
+	}
+	if (fclose(file) != 0) {
+		ok = 0;
+	}
+	if (ok && rename(tmp_path, path) != 0) {
+		ok = 0;
+	}
+	if (!ok) {
+		unlink(tmp_path);
+	}
+	free(tmp_path);
+	return ok ? 0 : -1;
+}
+
+//!===========================================================================
+//! Передача ділянки файлу в дескриптор без копіювання
+//!===========================================================================
+
+#define MY_STR_SEND_BUF (64u << 10)
+
+//! Дочекатися, поки в неблокуючий fd можна буде писати.
+static int wait_writable(int fd) {
+	struct pollfd pfd = {fd, POLLOUT, 0};
+	return poll(&pfd, 1, -1) < 0 && errno != EINTR ? -1 : 0;
+}
+
+//! Звичайний write() -- з відображення, якщо воно є, інакше через буфер.
+static int send_range_write(int fd_out, const my_str_map_t *src, size_t off, size_t len) {
+	char buf[MY_STR_SEND_BUF];
+	while (len > 0) {
+		const char *from;
+		size_t n = len;
+		if (src->data != NULL) {
+			from = src->data + off;
+		} else {
+			if (n > sizeof(buf)) {
+				n = sizeof(buf);
+			}
+			ssize_t got = pread(src->fd, buf, n, (off_t) off);
+			if (got < 0 && errno == EINTR) {
+				continue;
+			}
+			if (got <= 0) {
+				return -3;
+			}
+			from = buf;
+			n = (size_t) got;
+		}
+		ssize_t put = write(fd_out, from, n);
+		if (put < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN && wait_writable(fd_out) == 0) {
+				continue;
+			}
+			return -2;
+		}
+		off += (size_t) put;
+		len -= (size_t) put;
+	}
+	return 0;
+}
+
+#ifdef __linux__
+//! Один з системних викликів без копіювання через простір користувача.
+//! Повертає кількість переданих байт, 0 -- вичерпано файл,
+//! -1 -- виклик не підтримується для цієї пари дескрипторів (треба пробувати інший).
+static ssize_t send_range_once(int method, int fd_out, int fd_in, off_t *off, size_t len) {
+	switch (method) {
+	case 0:
+		return copy_file_range(fd_in, off, fd_out, NULL, len, 0);
+	case 1:
+		return sendfile(fd_out, fd_in, off, len);
+	default:
+		return splice(fd_in, off, fd_out, NULL, len, SPLICE_F_MOVE);
+	}
+}
+#endif
+
+//! Записати ділянку [off, off + len) файлу src у fd_out (сокет, канал чи файл).
+//! Де ядро дозволяє -- без копіювання в простір користувача: copy_file_range()
+//! для звичайних файлів, sendfile() чи splice() для сокетів і каналів.
+//! Інакше -- звичайний write(). Неблокуючий fd_out очікується через poll().
+//! len за межами файлу -- обрізається.
+//! -1 -- некоректні аргументи, -2 -- помилка запису, -3 -- помилка читання, 0 -- все ОК.
+int my_str_send_range(int fd_out, const my_str_map_t *src, size_t off, size_t len) {
+	if (src == NULL || src->fd < 0 || fd_out < 0 || off > src->size_m) {
+		return -1;
+	}
+	if (len > src->size_m - off) {
+		len = src->size_m - off;
+	}
+#ifdef __linux__
+	struct stat st;
+	int method = fstat(fd_out, &st) == 0 && S_ISREG(st.st_mode) ? 0 : 1;
+	off_t pos = (off_t) off;
+	while (len > 0 && method <= 2) {
+		ssize_t n = send_range_once(method, fd_out, src->fd, &pos, len);
+		if (n > 0) {
+			len -= (size_t) n;
+			continue;
+		}
+		if (n == 0) {
+			return -3;
+		}
+		if (errno == EINTR) {
+			continue;
+		}
+		if (errno == EAGAIN) {
+			if (wait_writable(fd_out) != 0) {
+				return -2;
+			}
+			continue;
+		}
+		if (errno != EINVAL && errno != ENOSYS && errno != EXDEV && errno != EOPNOTSUPP) {
+			return -2;
+		}
+		method++;
+	}
+	off = (size_t) pos;
+#endif
+	return send_range_write(fd_out, src, off, len);
+}
@@ -0,0 +1,21 @@
+#ifndef STRLIB_FILE_H
+#define STRLIB_FILE_H
+#include <stdio.h>
+#include "stringg.h"
+#include "str_view.h"
+
+//! Файл, відображений у пам'ять (лише для читання).
+typedef struct
+{
+	const char* data; // Початок відображення
+	size_t size_m;	  // Розмір файлу
+	int fd;			  // Дескриптор відкритого файлу
+} my_str_map_t;
+
+int my_str_map_file(my_str_map_t* map, const char* path);
+void my_str_unmap_file(my_str_map_t* map);
+my_str_view_t my_str_map_view(const my_str_map_t* map);
+FILE* my_str_replace_open(const char* path, char** tmp_path);
+int my_str_replace_commit(FILE* file, char* tmp_path, const char* path, int ok);
+int my_str_send_range(int fd_out, const my_str_map_t* src, size_t off, size_t len);
+#endif //STRLIB_FILE_H
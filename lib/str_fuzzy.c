@@ -0,0 +1,304 @@
+//
+// Нечіткий пошук у словнику: автомат Левенштейна поверх префіксного дерева.
+//
+#include <stdlib.h>
+#include <string.h>
+#include "str_fuzzy.h"
+
+static int view_cmp(my_str_view_t x, my_str_view_t y) {
+	int r = memcmp(x.data, y.data, x.size_m < y.size_m ? x.size_m : y.size_m);
+	if (r != 0) {
+		return r;
+	}
+	return (x.size_m > y.size_m) - (x.size_m < y.size_m);
+}
+
+//! Для сортування звичайним qsort(): стрічка разом зі своїм номером у vec.
+typedef struct {
+	my_str_view_t key;
+	uint32_t idx;
+} entry_t;
+
+static int entry_cmp(const void *a, const void *b) {
+	return view_cmp(((const entry_t *) a)->key, ((const entry_t *) b)->key);
+}
+
+//! Номери стрічок vec у лексикографічному порядку -- в order.
+static int sort_order(uint32_t *order, const my_str_vec_t *vec) {
+	entry_t *entries = malloc(sizeof(entry_t) * vec->size_m);
+	if (entries == NULL) {
+		return -2;
+	}
+	for (size_t i = 0; i < vec->size_m; i++) {
+		entries[i].key = my_str_vec_get(vec, i);
+		entries[i].idx = (uint32_t) i;
+	}
+	qsort(entries, vec->size_m, sizeof(entry_t), entry_cmp);
+	for (size_t i = 0; i < vec->size_m; i++) {
+		order[i] = entries[i].idx;
+	}
+	free(entries);
+	return 0;
+}
+
+static my_str_view_t word_at(const my_str_fuzzy_t *dict, size_t pos) {
+	return my_str_vec_get(dict->vec, dict->order[pos]);
+}
+
+//! Кінець гілки, що йде з lo байтом c на глибині depth: галопом,
+//! потім двійковим пошуком.
+static size_t branch_end(const my_str_fuzzy_t *dict, size_t lo, size_t hi, size_t depth, unsigned char c) {
+	size_t left = lo + 1;
+	size_t right = left;
+	size_t step = 1;
+	while (right < hi && (unsigned char) word_at(dict, right).data[depth] == c) {
+		left = right + 1;
+		step *= 2;
+		right = lo + step < hi ? lo + step : hi;
+	}
+	while (left < right) {
+		size_t mid = left + (right - left) / 2;
+		if ((unsigned char) word_at(dict, mid).data[depth] == c) {
+			left = mid + 1;
+		} else {
+			right = mid;
+		}
+	}
+	return left;
+}
+
+//! Побудувати дерево в ширину: діти кожного вузла додаються підряд у кінець,
+//! тож сам масив вузлів -- і черга обробки.
+static int build_trie(my_str_fuzzy_t *dict) {
+	size_t cap = 64;
+	dict->nodes = malloc(sizeof(my_str_fuzzy_node_t) * cap);
+	// Тимчасово для кожного вузла: кінець його стрічок і глибина.
+	uint32_t *hi = malloc(sizeof(uint32_t) * cap);
+	uint32_t *depth = malloc(sizeof(uint32_t) * cap);
+	if (dict->nodes == NULL || hi == NULL || depth == NULL) {
+		free(hi);
+		free(depth);
+		return -2;
+	}
+	memset(&dict->nodes[0], 0, sizeof(my_str_fuzzy_node_t));
+	hi[0] = (uint32_t) dict->size_m;
+	depth[0] = 0;
+	dict->nnodes = 1;
+	for (size_t q = 0; q < dict->nnodes; q++) {
+		my_str_fuzzy_node_t *node = &dict->nodes[q];
+		size_t lo = node->lo;
+		size_t end = hi[q];
+		size_t d = depth[q];
+		node->child = (uint32_t) dict->nnodes;
+		if (end - lo < 2) {
+			continue;
+		}
+		while (lo < end && word_at(dict, lo).size_m == d) {
+			lo++;
+		}
+		while (lo < end) {
+			unsigned char c = (unsigned char) word_at(dict, lo).data[d];
+			size_t next = branch_end(dict, lo, end, d, c);
+			if (dict->nnodes == cap) {
+				cap *= 2;
+				my_str_fuzzy_node_t *nodes = realloc(dict->nodes, sizeof(my_str_fuzzy_node_t) * cap);
+				uint32_t *h = realloc(hi, sizeof(uint32_t) * cap);
+				uint32_t *dp = realloc(depth, sizeof(uint32_t) * cap);
+				if (nodes != NULL) {
+					dict->nodes = nodes;
+				}
+				if (h != NULL) {
+					hi = h;
+				}
+				if (dp != NULL) {
+					depth = dp;
+				}
+				if (nodes == NULL || h == NULL || dp == NULL) {
+					free(hi);
+					free(depth);
+					return -2;
+				}
+				node = &dict->nodes[q];
+			}
+			my_str_fuzzy_node_t *child = &dict->nodes[dict->nnodes];
+			child->lo = (uint32_t) lo;
+			child->child = 0;
+			child->nchild = 0;
+			child->label = c;
+			hi[dict->nnodes] = (uint32_t) next;
+			depth[dict->nnodes] = (uint32_t) d + 1;
+			dict->nnodes++;
+			node->nchild++;
+			lo = next;
+		}
+	}
+	free(hi);
+	free(depth);
+	return 0;
+}
+
+//! Упорядкувати словник і побудувати над ним префіксне дерево.
+//! Якщо vec уже впорядкований -- без сортування.
+//! Після використання -- викличте my_str_fuzzy_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять,
+//! -3 -- більше ніж 2^32 - 1 стрічок, 0 -- все ОК.
+int my_str_fuzzy_create(my_str_fuzzy_t *dict, const my_str_vec_t *vec) {
+	if (dict == NULL || vec == NULL) {
+		return -1;
+	}
+	if (vec->size_m >= UINT32_MAX) {
+		return -3;
+	}
+	memset(dict, 0, sizeof(*dict));
+	dict->vec = vec;
+	dict->size_m = vec->size_m;
+	dict->order = malloc(sizeof(uint32_t) * (vec->size_m + 1));
+	if (dict->order == NULL) {
+		return -2;
+	}
+	int sorted = 1;
+	for (size_t i = 0; i < vec->size_m; i++) {
+		dict->order[i] = (uint32_t) i;
+		if (i > 0 && sorted && view_cmp(my_str_vec_get(vec, i - 1), my_str_vec_get(vec, i)) > 0) {
+			sorted = 0;
+		}
+	}
+	if ((!sorted && sort_order(dict->order, vec) != 0) || build_trie(dict) != 0) {
+		my_str_fuzzy_free(dict);
+		return -2;
+	}
+	return 0;
+}
+
+void my_str_fuzzy_free(my_str_fuzzy_t *dict) {
+	if (dict != NULL) {
+		free(dict->order);
+		free(dict->nodes);
+		dict->order = NULL;
+		dict->nodes = NULL;
+		dict->size_m = 0;
+		dict->nnodes = 0;
+	}
+}
+
+//! Стан обходу: рядки таблиці ДП -- по одному на глибину дерева.
+//! Рядок -- стан автомата Левенштейна для запиту після префікса.
+typedef struct {
+	const my_str_fuzzy_t *dict;
+	my_str_view_t query;
+	size_t max;
+	uint32_t *rows;	// rows[d * (query.size_m + 1) + i]
+	my_str_fuzzy_match_t *matches;
+	size_t max_matches;
+	size_t found;
+} walk_t;
+
+//! Рядок ДП для глибини depth (префікс + байт c) з рядка depth - 1.
+//! Поза смугою |i - depth| <= max клітинки все одно більші за max.
+//! Повертає мінімум рядка: якщо він більший за max, гілка мертва.
+static uint32_t next_row(walk_t *w, size_t depth, unsigned char c) {
+	size_t m = w->query.size_m;
+	uint32_t limit = (uint32_t) w->max + 1;
+	const uint32_t *prev = w->rows + (depth - 1) * (m + 1);
+	uint32_t *row = w->rows + depth * (m + 1);
+	size_t from = depth > w->max ? depth - w->max : 1;
+	size_t to = depth + w->max < m ? depth + w->max : m;
+	uint32_t best = limit;
+	row[0] = depth < limit ? (uint32_t) depth : limit;
+	if (row[0] < best) {
+		best = row[0];
+	}
+	for (size_t i = 1; i < from && i <= m; i++) {
+		row[i] = limit;
+	}
+	for (size_t i = from; i <= to; i++) {
+		uint32_t v = prev[i - 1] + ((unsigned char) w->query.data[i - 1] != c);
+		if (prev[i] + 1 < v) {
+			v = prev[i] + 1;
+		}
+		if (row[i - 1] + 1 < v) {
+			v = row[i - 1] + 1;
+		}
+		if (v > limit) {
+			v = limit;
+		}
+		row[i] = v;
+		if (v < best) {
+			best = v;
+		}
+	}
+	for (size_t i = to + 1; i <= m; i++) {
+		row[i] = limit;
+	}
+	return best;
+}
+
+static void report(walk_t *w, size_t pos, size_t depth) {
+	uint32_t dist = w->rows[depth * (w->query.size_m + 1) + w->query.size_m];
+	if (dist > w->max) {
+		return;
+	}
+	if (w->found < w->max_matches) {
+		w->matches[w->found].index = w->dict->order[pos];
+		w->matches[w->found].dist = dist;
+	}
+	w->found++;
+}
+
+//! Обійти вузол на глибині depth, чиї стрічки -- order[lo, hi).
+static void walk(walk_t *w, size_t node, size_t hi, size_t depth) {
+	const my_str_fuzzy_node_t *n = &w->dict->nodes[node];
+	size_t lo = n->lo;
+	size_t limit = w->query.size_m + w->max;
+	if (hi - lo == 1) {
+		// Лист: решту єдиної стрічки проходимо прямо по її байтах.
+		my_str_view_t word = word_at(w->dict, lo);
+		for (; depth < word.size_m; depth++) {
+			if (depth >= limit || next_row(w, depth + 1, (unsigned char) word.data[depth]) > w->max) {
+				return;
+			}
+		}
+		report(w, lo, depth);
+		return;
+	}
+	// Стрічки, що закінчуються тут, стоять першими.
+	for (; lo < hi && word_at(w->dict, lo).size_m == depth; lo++) {
+		report(w, lo, depth);
+	}
+	if (depth >= limit) {
+		return;
+	}
+	for (size_t c = n->child; c < (size_t) n->child + n->nchild; c++) {
+		size_t end = c + 1 < (size_t) n->child + n->nchild ? w->dict->nodes[c + 1].lo : hi;
+		if (next_row(w, depth + 1, w->dict->nodes[c].label) <= w->max) {
+			walk(w, c, end, depth + 1);
+		}
+	}
+}
+
+//! Усі слова словника на відстані Левенштейна не більше max від query.
+//! Обходяться лише гілки, де ще можливо вкластися в max, тож для max 1-2
+//! перевіряється мала частка словника. До max_matches знайдених -- у
+//! matches (у порядку словника). Повертає загальну кількість знайдених;
+//! (size_t)-1 -- нульовий вказівник, завеликий max або не вдалося виділити пам'ять.
+size_t my_str_fuzzy_lookup(const my_str_fuzzy_t *dict, my_str_view_t query, size_t max, my_str_fuzzy_match_t *matches, size_t max_matches) {
+	if (dict == NULL || dict->nodes == NULL || (query.data == NULL && query.size_m > 0) || (matches == NULL && max_matches > 0)) {
+		return (size_t) -1;
+	}
+	if (max >= UINT32_MAX - 1) {
+		return (size_t) -1;
+	}
+	walk_t w = {dict, query, max, NULL, matches, max_matches, 0};
+	w.rows = malloc(sizeof(uint32_t) * (query.size_m + max + 1) * (query.size_m + 1));
+	if (w.rows == NULL) {
+		return (size_t) -1;
+	}
+	for (size_t i = 0; i <= query.size_m; i++) {
+		w.rows[i] = i <= max ? (uint32_t) i : (uint32_t) max + 1;
+	}
+	if (dict->size_m > 0) {
+		walk(&w, 0, dict->size_m, 0);
+	}
+	free(w.rows);
+	return w.found;
+}
@@ -0,0 +1,41 @@
+#ifndef STRLIB_FUZZY_H
+#define STRLIB_FUZZY_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+#include "str_vec.h"
+
+//! Вузол префіксного дерева. Діти вузла лежать підряд; стрічки вузла --
+//! order[lo] до lo наступного брата (спершу ті, що тут закінчуються).
+//! Вузол з однією стрічкою -- лист: її решта не розкладається на вузли.
+typedef struct
+{
+	uint32_t lo;	  // Перша стрічка вузла в order
+	uint32_t child;	  // Перша дитина
+	uint16_t nchild;
+	uint8_t label;	  // Байт на ребрі від батька
+} my_str_fuzzy_node_t;
+
+//! Словник для нечіткого пошуку: префіксне дерево над my_str_vec_t
+//! (масив не копіюється і має жити довше).
+typedef struct
+{
+	const my_str_vec_t* vec;
+	uint32_t* order;			 // Номери стрічок vec у порядку зростання
+	size_t size_m;
+	my_str_fuzzy_node_t* nodes;	 // nodes[0] -- корінь
+	size_t nnodes;
+} my_str_fuzzy_t;
+
+//! Знайдене слово словника.
+typedef struct
+{
+	size_t index;	// Номер стрічки у vec
+	size_t dist;	// Відстань Левенштейна до запиту
+} my_str_fuzzy_match_t;
+
+int my_str_fuzzy_create(my_str_fuzzy_t* dict, const my_str_vec_t* vec);
+void my_str_fuzzy_free(my_str_fuzzy_t* dict);
+size_t my_str_fuzzy_lookup(const my_str_fuzzy_t* dict, my_str_view_t query, size_t max, my_str_fuzzy_match_t* matches, size_t max_matches);
+#endif //STRLIB_FUZZY_H
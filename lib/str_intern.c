@@ -0,0 +1,491 @@
+//
+// Інтернування стрічок: спільна паралельна таблиця з ручками замість копій.
+//
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "str_intern.h"
+#include "str_file.h"
+
+#define CHUNK_SIZE (64u << 10)
+#define SEGMENT_BASE 1024
+#define MAX_HANDLE (UINT32_MAX - SEGMENT_BASE)
+#define INTERN_HOLE UINT64_MAX // Довжина в записі файлу для діри від невдалої вставки
+
+//! Блок арени: заголовок-посилання на попередній, далі вміст стрічок.
+typedef struct chunk {
+	struct chunk *next;
+	char data[];
+} chunk_t;
+
+static my_str_intern_table_t *table_alloc(size_t size) {
+	my_str_intern_table_t *t = calloc(1, sizeof(*t) + sizeof(uint64_t) * size);
+	if (t != NULL) {
+		t->mask = size - 1;
+	}
+	return t;
+}
+
+//! Створити порожню таблицю на capacity стрічок (0 -- за замовчуванням;
+//! вона й так зростає). Після використання -- викличте my_str_intern_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_intern_create(my_str_intern_t *intern, size_t capacity) {
+	if (intern == NULL) {
+		return -1;
+	}
+	memset(intern, 0, sizeof(*intern));
+	size_t size = 1024;
+	while (size < capacity * 2) {
+		size *= 2;
+	}
+	intern->table = table_alloc(size);
+	if (intern->table == NULL) {
+		return -2;
+	}
+	for (size_t s = 0; s < MY_STR_INTERN_STRIPES; s++) {
+		pthread_mutex_init(&intern->stripes[s].lock, NULL);
+	}
+	return 0;
+}
+
+//! Звільнити таблицю, усі арени й записи. Ручки та вказівники стають недійсними.
+void my_str_intern_free(my_str_intern_t *intern) {
+	if (intern == NULL || intern->table == NULL) {
+		return;
+	}
+	for (my_str_intern_table_t *t = intern->table; t != NULL;) {
+		my_str_intern_table_t *prev = t->prev;
+		free(t);
+		t = prev;
+	}
+	for (size_t s = 0; s < 32; s++) {
+		free(intern->segments[s]);
+	}
+	for (size_t s = 0; s < MY_STR_INTERN_STRIPES; s++) {
+		my_str_intern_stripe_t *stripe = &intern->stripes[s];
+		for (chunk_t *c = stripe->chunks; c != NULL;) {
+			chunk_t *next = c->next;
+			free(c);
+			c = next;
+		}
+		pthread_mutex_destroy(&stripe->lock);
+	}
+	if (intern->map != NULL) {
+		munmap(intern->map, intern->map_len);
+	}
+	memset(intern, 0, sizeof(*intern));
+}
+
+//! Запис ручки, доданої в пам'яті (не з основи): сегменти подвоюються
+//! й ніколи не переміщуються, тож читати можна без блокувань.
+static my_str_intern_entry_t *entry_at(const my_str_intern_t *intern, uint32_t handle) {
+	size_t idx = (size_t) handle - intern->base_count + SEGMENT_BASE;
+	size_t seg = (size_t) (63 - __builtin_clzll(idx)) - 10;
+	my_str_intern_entry_t *segment = __atomic_load_n(&intern->segments[seg], __ATOMIC_ACQUIRE);
+	return segment ? segment + (idx - ((size_t) SEGMENT_BASE << seg)) : NULL;
+}
+
+static my_str_intern_entry_t *entry_make(my_str_intern_t *intern, uint32_t handle) {
+	size_t idx = (size_t) handle - intern->base_count + SEGMENT_BASE;
+	size_t seg = (size_t) (63 - __builtin_clzll(idx)) - 10;
+	if (__atomic_load_n(&intern->segments[seg], __ATOMIC_ACQUIRE) == NULL) {
+		my_str_intern_entry_t *segment = calloc((size_t) SEGMENT_BASE << seg, sizeof(my_str_intern_entry_t));
+		my_str_intern_entry_t *expected = NULL;
+		if (segment == NULL) {
+			return NULL;
+		}
+		// Сегмент могла вже додати інша смуга -- тоді свій не потрібен.
+		if (!__atomic_compare_exchange_n(&intern->segments[seg], &expected, segment, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			free(segment);
+		}
+	}
+	return entry_at(intern, handle);
+}
+
+//! Шукати str у таблиці t: ручка або 0.
+static uint32_t table_find(const my_str_intern_t *intern, const my_str_intern_table_t *t, my_str_view_t str, uint32_t tag) {
+	for (size_t pos = tag & t->mask;; pos = (pos + 1) & t->mask) {
+		uint64_t slot = __atomic_load_n(&t->slots[pos], __ATOMIC_ACQUIRE);
+		if (slot == 0) {
+			return 0;
+		}
+		if ((uint32_t) (slot >> 32) != tag) {
+			continue;
+		}
+		const my_str_intern_entry_t *e = entry_at(intern, (uint32_t) slot);
+		if (e->size_m == str.size_m && (str.size_m == 0 || memcmp(e->data, str.data, str.size_m) == 0)) {
+			return (uint32_t) slot;
+		}
+	}
+}
+
+//! Шукати str в основі з файлу: ручка або 0.
+static uint32_t base_find(const my_str_intern_t *intern, my_str_view_t str, uint32_t tag) {
+	if (intern->base_slots == NULL) {
+		return 0;
+	}
+	for (size_t pos = tag & intern->base_mask;; pos = (pos + 1) & intern->base_mask) {
+		uint64_t slot = intern->base_slots[pos];
+		if (slot == 0) {
+			return 0;
+		}
+		if ((uint32_t) (slot >> 32) != tag) {
+			continue;
+		}
+		const my_str_vec_entry_t *e = &intern->base_entries[(uint32_t) slot - 1];
+		if (e->size_m == str.size_m && (str.size_m == 0 || memcmp(intern->base_blob + e->off, str.data, str.size_m) == 0)) {
+			return (uint32_t) slot;
+		}
+	}
+}
+
+//! Зайняти порожній слот; за той самий слот можуть змагатися вставки
+//! з інших смуг.
+static void table_put(my_str_intern_table_t *t, uint64_t value) {
+	uint32_t tag = (uint32_t) (value >> 32);
+	for (size_t pos = tag & t->mask;; pos = (pos + 1) & t->mask) {
+		uint64_t expected = 0;
+		if (__atomic_compare_exchange_n(&t->slots[pos], &expected, value, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+			return;
+		}
+	}
+}
+
+//! Збільшити таблицю вдвічі, тримаючи всі смуги (вставок тоді немає).
+//! Читачі старої таблиці дочитують її спокійно -- вона не звільняється.
+static int table_grow(my_str_intern_t *intern) {
+	for (size_t s = 0; s < MY_STR_INTERN_STRIPES; s++) {
+		pthread_mutex_lock(&intern->stripes[s].lock);
+	}
+	int rc = 0;
+	my_str_intern_table_t *old = intern->table;
+	if (2 * (intern->count - intern->base_count + 1) > old->mask + 1) {
+		my_str_intern_table_t *t = table_alloc(2 * (old->mask + 1));
+		if (t == NULL) {
+			rc = -2;
+		} else {
+			for (size_t i = 0; i <= old->mask; i++) {
+				if (old->slots[i] != 0) {
+					table_put(t, old->slots[i]);
+				}
+			}
+			t->prev = old;
+			__atomic_store_n(&intern->table, t, __ATOMIC_RELEASE);
+		}
+	}
+	for (size_t s = MY_STR_INTERN_STRIPES; s-- > 0;) {
+		pthread_mutex_unlock(&intern->stripes[s].lock);
+	}
+	return rc;
+}
+
+//! Скопіювати вміст у арену смуги (із завершальним нулем).
+static char *stripe_store(my_str_intern_stripe_t *stripe, my_str_view_t str) {
+	size_t need = str.size_m + 1;
+	if (stripe->chunk == NULL || stripe->size - stripe->used < need) {
+		size_t size = need > CHUNK_SIZE ? need : CHUNK_SIZE;
+		chunk_t *c = malloc(sizeof(chunk_t) + size);
+		if (c == NULL) {
+			return NULL;
+		}
+		c->next = stripe->chunks;
+		stripe->chunks = c;
+		stripe->chunk = c->data;
+		stripe->used = 0;
+		stripe->size = size;
+	}
+	char *p = stripe->chunk + stripe->used;
+	memcpy(p, str.data, str.size_m);
+	p[str.size_m] = '\0';
+	stripe->used += need;
+	return p;
+}
+
+//! Ручка стрічки з таким вмістом, без додавання; 0 -- такої немає.
+//! Не блокує. Безпечно одночасно з my_str_intern() з інших потоків.
+uint32_t my_str_intern_find(const my_str_intern_t *intern, my_str_view_t str) {
+	if (intern == NULL || (str.data == NULL && str.size_m > 0)) {
+		return 0;
+	}
+	const my_str_intern_table_t *t = __atomic_load_n(&intern->table, __ATOMIC_ACQUIRE);
+	if (t == NULL) {
+		return 0;
+	}
+	uint32_t tag = (uint32_t) (my_str_hash(str) >> 32);
+	uint32_t handle = base_find(intern, str, tag);
+	return handle != 0 ? handle : table_find(intern, t, str, tag);
+}
+
+//! Ручка для вмісту str: та сама для однакового вмісту з будь-якого потоку,
+//! доки таблиця жива. Уперше побачений вміст копіюється в арену один раз.
+//! Ручки -- від 1 підряд; 0 -- нульовий вказівник або не вдалося виділити пам'ять.
+//! Уже відомі стрічки знаходяться без блокувань; нові -- під блокуванням
+//! лише своєї смуги з MY_STR_INTERN_STRIPES.
+uint32_t my_str_intern(my_str_intern_t *intern, my_str_view_t str) {
+	if (intern == NULL || (str.data == NULL && str.size_m > 0)) {
+		return 0;
+	}
+	const my_str_intern_table_t *current = __atomic_load_n(&intern->table, __ATOMIC_ACQUIRE);
+	if (current == NULL) {
+		return 0;
+	}
+	uint64_t hash = my_str_hash(str);
+	uint32_t tag = (uint32_t) (hash >> 32);
+	uint32_t handle = base_find(intern, str, tag);
+	if (handle == 0) {
+		handle = table_find(intern, current, str, tag);
+	}
+	if (handle != 0) {
+		return handle;
+	}
+	my_str_intern_stripe_t *stripe = &intern->stripes[hash % MY_STR_INTERN_STRIPES];
+	for (;;) {
+		pthread_mutex_lock(&stripe->lock);
+		// Той самий вміст завжди в тій самій смузі -- під її блокуванням
+		// його ніхто інший не вставить; лишається перевірити ще раз.
+		my_str_intern_table_t *t = intern->table;
+		handle = table_find(intern, t, str, tag);
+		if (handle != 0) {
+			pthread_mutex_unlock(&stripe->lock);
+			return handle;
+		}
+		size_t count = __atomic_add_fetch(&intern->count, 1, __ATOMIC_RELAXED);
+		if (2 * (count - intern->base_count) <= t->mask + 1 && count <= MAX_HANDLE) {
+			handle = (uint32_t) count;
+			break;
+		}
+		__atomic_sub_fetch(&intern->count, 1, __ATOMIC_RELAXED);
+		pthread_mutex_unlock(&stripe->lock);
+		if (count > MAX_HANDLE || table_grow(intern) != 0) {
+			return 0;
+		}
+	}
+	my_str_intern_entry_t *e = entry_make(intern, handle);
+	char *data = e ? stripe_store(stripe, str) : NULL;
+	if (data == NULL) {
+		// Номер уже видано -- лишається дірою, таблиця не змінюється.
+		pthread_mutex_unlock(&stripe->lock);
+		return 0;
+	}
+	e->data = data;
+	e->size_m = str.size_m;
+	table_put(intern->table, (uint64_t) tag << 32 | handle);
+	pthread_mutex_unlock(&stripe->lock);
+	return handle;
+}
+
+//! my_str_intern() для my_str_t.
+uint32_t my_str_intern_str(my_str_intern_t *intern, const my_str_t *str) {
+	if (str == NULL) {
+		return 0;
+	}
+	return my_str_intern(intern, my_str_view(str));
+}
+
+//! Вміст ручки -- погляд в арену, дійсний до my_str_intern_free().
+//! Для недійсної ручки чи діри від невдалої вставки -- порожній погляд із NULL.
+my_str_view_t my_str_intern_get(const my_str_intern_t *intern, uint32_t handle) {
+	my_str_view_t view = {NULL, 0};
+	if (intern == NULL || handle == 0 || handle > __atomic_load_n(&intern->count, __ATOMIC_ACQUIRE)) {
+		return view;
+	}
+	if (handle <= intern->base_count) {
+		const my_str_vec_entry_t *b = &intern->base_entries[handle - 1];
+		if (b->size_m == INTERN_HOLE) {
+			return view;
+		}
+		view.data = intern->base_blob + b->off;
+		view.size_m = (size_t) b->size_m;
+		return view;
+	}
+	const my_str_intern_entry_t *e = entry_at(intern, handle);
+	if (e != NULL && e->data != NULL) {
+		view.data = e->data;
+		view.size_m = e->size_m;
+	}
+	return view;
+}
+
+//! Кількість різних стрічок (разом із дірами від невдалих вставок).
+size_t my_str_intern_size(const my_str_intern_t *intern) {
+	return intern ? __atomic_load_n(&intern->count, __ATOMIC_RELAXED) : 0;
+}
+
+//!===========================================================================
+//! Збереження та завантаження
+//!===========================================================================
+
+//! Формат файлу (числа -- у порядку байтів машини, що писала; порядок
+//! перевіряється за полем version):
+//!   заголовок intern_header_t,
+//!   table_size слотів uint64_t -- як у таблиці в пам'яті, з ручками,
+//!   count записів my_str_vec_entry_t (зсув і довжина в блоці; у діри від
+//!   невдалої вставки -- довжина INTERN_HOLE і зсув 0),
+//!   blob_size байт вмісту, кожна стрічка -- із завершальним нулем.
+#define INTERN_MAGIC "MYSTRINT"
+#define INTERN_VERSION 1
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t header_size;
+	uint64_t count;
+	uint64_t table_size;
+	uint64_t blob_size;
+	uint64_t reserved;
+} intern_header_t;
+
+//! Записати всі стрічки (основу й додані) у файл, ручки зберігаються.
+//! Не можна викликати одночасно з my_str_intern() з інших потоків.
+//! Файл підмінюється цілим (тимчасовий файл і rename()), тож таблицю,
+//! завантажену з path і доповнену, можна зберегти назад у path.
+//! -1 -- нульовий вказівник, -2 -- не вдалося відкрити файл чи виділити
+//! пам'ять, -3 -- помилка запису.
+int my_str_intern_save(const my_str_intern_t *intern, const char *path) {
+	if (intern == NULL || intern->table == NULL || path == NULL) {
+		return -1;
+	}
+	size_t count = intern->count;
+	size_t size = 1024;
+	while (size < 2 * count) {
+		size *= 2;
+	}
+	intern_header_t hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, INTERN_MAGIC, 8);
+	hdr.version = INTERN_VERSION;
+	hdr.header_size = sizeof(hdr);
+	hdr.count = count;
+	hdr.table_size = size;
+
+	my_str_intern_table_t *t = table_alloc(size);
+	my_str_vec_entry_t *entries = malloc(sizeof(my_str_vec_entry_t) * (count ? count : 1));
+	if (t == NULL || entries == NULL) {
+		free(t);
+		free(entries);
+		return -2;
+	}
+	for (size_t h = 1; h <= count; h++) {
+		my_str_view_t v = my_str_intern_get(intern, (uint32_t) h);
+		// Діри від невдалих вставок -- позначені, без слота й вмісту.
+		if (v.data == NULL) {
+			entries[h - 1].off = 0;
+			entries[h - 1].size_m = INTERN_HOLE;
+			continue;
+		}
+		entries[h - 1].off = hdr.blob_size;
+		entries[h - 1].size_m = v.size_m;
+		table_put(t, (uint64_t) (my_str_hash(v) >> 32) << 32 | h);
+		hdr.blob_size += v.size_m + 1;
+	}
+	char *tmp;
+	FILE *file = my_str_replace_open(path, &tmp);
+	if (file == NULL) {
+		free(t);
+		free(entries);
+		return -2;
+	}
+	int ok = fwrite(&hdr, sizeof(hdr), 1, file) == 1 &&
+			 fwrite(t->slots, sizeof(uint64_t), size, file) == size &&
+			 fwrite(entries, sizeof(my_str_vec_entry_t), count, file) == count;
+	for (size_t h = 1; ok && h <= count; h++) {
+		my_str_view_t v = my_str_intern_get(intern, (uint32_t) h);
+		if (v.data != NULL) {
+			ok = (v.size_m == 0 || fwrite(v.data, 1, v.size_m, file) == v.size_m) && fputc('\0', file) != EOF;
+		}
+	}
+	free(t);
+	free(entries);
+	return my_str_replace_commit(file, tmp, path, ok) == 0 ? 0 : -3;
+}
+
+//! Чи можна довіряти слотам і записам основи: кожен слот порожній або
+//! з ручкою 1..count, що не є дірою (і є хоч один порожній, інакше пошук
+//! не зупиниться), кожна стрічка -- в межах блоку і завершується нулем.
+//! O(розміру файлу).
+static int intern_verify(const intern_header_t *hdr, const uint64_t *slots, const my_str_vec_entry_t *entries,
+						 const char *blob) {
+	size_t empty = 0;
+	for (size_t i = 0; i < hdr->table_size; i++) {
+		uint32_t handle = (uint32_t) slots[i];
+		if (slots[i] == 0) {
+			empty++;
+		} else if (handle == 0 || handle > hdr->count || entries[handle - 1].size_m == INTERN_HOLE) {
+			return 0;
+		}
+	}
+	if (empty == 0) {
+		return 0;
+	}
+	for (size_t h = 0; h < hdr->count; h++) {
+		uint64_t off = entries[h].off;
+		uint64_t size = entries[h].size_m;
+		if (size == INTERN_HOLE) {
+			continue;
+		}
+		if (off >= hdr->blob_size || size >= hdr->blob_size - off || blob[off + size] != '\0') {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+//! Створити таблицю з файлу my_str_intern_save(): файл відображається
+//! в пам'ять лише для читання й нічого не розбирається -- O(1) від розміру.
+//! Збережені ручки зберігаються; нові стрічки додаються в пам'яті (файл не
+//! змінюється). Після використання -- викличте my_str_intern_free().
+//! Без MY_STR_INTERN_VERIFY перевіряються лише заголовок і розміри частин,
+//! а слотам і записам файлу довіряється: пошкоджений файл дасть читання
+//! за межами відображення чи нескінченний пошук. Для недовірених файлів
+//! передайте MY_STR_INTERN_VERIFY -- це один прохід по всьому файлу.
+//! -1 -- нульовий вказівник, -2 -- не вдалося відкрити чи відобразити файл
+//! або виділити пам'ять, -3 -- файл не цього формату або пошкоджений.
+int my_str_intern_load(my_str_intern_t *intern, const char *path, int flags) {
+	if (intern == NULL || path == NULL) {
+		return -1;
+	}
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return -2;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(intern_header_t)) {
+		close(fd);
+		return -3;
+	}
+	size_t len = (size_t) st.st_size;
+	void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		return -2;
+	}
+	const intern_header_t *hdr = map;
+	size_t rest = len - sizeof(*hdr);
+	int ok = memcmp(hdr->magic, INTERN_MAGIC, 8) == 0 && hdr->version == INTERN_VERSION &&
+			 hdr->header_size == sizeof(*hdr) && hdr->count <= MAX_HANDLE &&
+			 hdr->table_size >= 2 && (hdr->table_size & (hdr->table_size - 1)) == 0 &&
+			 hdr->count < hdr->table_size && hdr->table_size <= rest / sizeof(uint64_t) &&
+			 hdr->count <= (rest - hdr->table_size * sizeof(uint64_t)) / sizeof(my_str_vec_entry_t) &&
+			 hdr->table_size * sizeof(uint64_t) + hdr->count * sizeof(my_str_vec_entry_t) + hdr->blob_size == rest;
+	const char *p = (const char *) map + sizeof(*hdr);
+	const my_str_vec_entry_t *entries = ok ? (const my_str_vec_entry_t *) (p + hdr->table_size * sizeof(uint64_t)) : NULL;
+	if (ok && (flags & MY_STR_INTERN_VERIFY)) {
+		ok = intern_verify(hdr, (const uint64_t *) p, entries, (const char *) (entries + hdr->count));
+	}
+	if (!ok || my_str_intern_create(intern, 0) != 0) {
+		munmap(map, len);
+		return ok ? -2 : -3;
+	}
+	intern->map = map;
+	intern->map_len = len;
+	intern->base_slots = (const uint64_t *) p;
+	intern->base_mask = (size_t) hdr->table_size - 1;
+	intern->base_entries = entries;
+	intern->base_blob = (const char *) (intern->base_entries + hdr->count);
+	intern->base_count = (size_t) hdr->count;
+	intern->count = intern->base_count;
+	return 0;
+}
@@ -0,0 +1,69 @@
+#ifndef STRLIB_INTERN_H
+#define STRLIB_INTERN_H
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "stringg.h"
+#include "str_view.h"
+#include "str_vec.h"
+
+#define MY_STR_INTERN_STRIPES 64
+#define MY_STR_INTERN_VERIFY 1 // my_str_intern_load(): перевірити слоти й межі всіх стрічок
+
+//! Хеш-таблиця з відкритою адресацією: слот -- (старші 32 біти хешу << 32) | ручка,
+//! 0 -- порожній. Старі таблиці після збільшення живуть до my_str_intern_free().
+typedef struct my_str_intern_table
+{
+	struct my_str_intern_table* prev;
+	size_t mask;
+	uint64_t slots[];
+} my_str_intern_table_t;
+
+//! Смуга блокування вставок; у кожної -- своя арена для вмісту.
+typedef struct
+{
+	pthread_mutex_t lock;
+	char* chunk;		// Поточний блок арени
+	size_t used;		// Зайнято в ньому
+	size_t size;
+	void* chunks;		// Список усіх блоків смуги
+	char pad[64];
+} my_str_intern_stripe_t;
+
+//! Рядок, на який вказує ручка.
+typedef struct
+{
+	const char* data;	// Завершується нулем
+	size_t size_m;
+} my_str_intern_entry_t;
+
+//! Таблиця інтернування: однаковий вміст -- та сама ручка і той самий
+//! вказівник, тож рівність перевіряється порівнянням чисел.
+//! Пошук -- без блокувань, вставки -- під блокуванням однієї смуги.
+//! Після my_str_intern_load() ручки 1..base_count -- з відображеного файлу
+//! (лише читання), нові стрічки додаються в таблицю в пам'яті поверх нього.
+typedef struct
+{
+	my_str_intern_table_t* table;
+	my_str_intern_entry_t* segments[32]; // Сегмент s -- 1024 << s записів
+	size_t count;						 // Кількість різних стрічок, разом з основою
+	my_str_intern_stripe_t stripes[MY_STR_INTERN_STRIPES];
+	const uint64_t* base_slots;			 // Слоти основи у відображенні, або NULL
+	size_t base_mask;
+	const my_str_vec_entry_t* base_entries; // Запис ручки h -- base_entries[h - 1]
+	const char* base_blob;
+	size_t base_count;
+	void* map;
+	size_t map_len;
+} my_str_intern_t;
+
+int my_str_intern_create(my_str_intern_t* intern, size_t capacity);
+void my_str_intern_free(my_str_intern_t* intern);
+uint32_t my_str_intern(my_str_intern_t* intern, my_str_view_t str);
+uint32_t my_str_intern_str(my_str_intern_t* intern, const my_str_t* str);
+uint32_t my_str_intern_find(const my_str_intern_t* intern, my_str_view_t str);
+my_str_view_t my_str_intern_get(const my_str_intern_t* intern, uint32_t handle);
+size_t my_str_intern_size(const my_str_intern_t* intern);
+int my_str_intern_save(const my_str_intern_t* intern, const char* path);
+int my_str_intern_load(my_str_intern_t* intern, const char* path, int flags);
+#endif //STRLIB_INTERN_H
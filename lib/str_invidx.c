@@ -0,0 +1,443 @@
+//
+// Інвертований індекс: термін -> стиснений список документів.
+//
+#include <stdlib.h>
+#include <string.h>
+#include "str_invidx.h"
+#include "str_split.h"
+
+#define NOT_FOUND ((size_t) -1)
+
+//!===========================================================================
+//! Списки документів
+//!===========================================================================
+
+static int posting_append(my_str_posting_t *p, uint32_t doc) {
+	if (p->count % MY_STR_INVIDX_BLOCK == 0) {
+		// Новий блок: перший документ -- у пропусках, а не в байтах.
+		if (p->nskips == p->cap_skips) {
+			size_t cap = p->cap_skips ? p->cap_skips * 2 : 1;
+			my_str_invidx_skip_t *skips = realloc(p->skips, sizeof(*skips) * cap);
+			if (skips == NULL) {
+				return -2;
+			}
+			p->skips = skips;
+			p->cap_skips = cap;
+		}
+		p->skips[p->nskips].first = doc;
+		p->skips[p->nskips].offset = (uint32_t) p->size_m;
+		p->nskips++;
+	} else {
+		if (p->size_m + 5 > p->capacity_m) {
+			size_t cap = p->capacity_m ? p->capacity_m * 2 : 16;
+			uint8_t *bytes = realloc(p->bytes, cap);
+			if (bytes == NULL) {
+				return -2;
+			}
+			p->bytes = bytes;
+			p->capacity_m = cap;
+		}
+		uint32_t delta = doc - p->last;
+		while (delta >= 0x80) {
+			p->bytes[p->size_m++] = (uint8_t) (delta | 0x80);
+			delta >>= 7;
+		}
+		p->bytes[p->size_m++] = (uint8_t) delta;
+	}
+	p->last = doc;
+	p->count++;
+	return 0;
+}
+
+//! Курсор по списку: поточний блок розпаковано в buf.
+typedef struct {
+	const my_str_posting_t *p;
+	size_t block;
+	uint32_t buf[MY_STR_INVIDX_BLOCK];
+	size_t n;
+	size_t i;
+} cursor_t;
+
+static void cursor_load(cursor_t *c, size_t block) {
+	const my_str_posting_t *p = c->p;
+	const uint8_t *b = p->bytes + p->skips[block].offset;
+	size_t left = p->count - block * MY_STR_INVIDX_BLOCK;
+	c->n = left < MY_STR_INVIDX_BLOCK ? left : MY_STR_INVIDX_BLOCK;
+	c->block = block;
+	c->i = 0;
+	uint32_t doc = p->skips[block].first;
+	c->buf[0] = doc;
+	for (size_t k = 1; k < c->n; k++) {
+		uint32_t delta = 0;
+		int shift = 0;
+		while (*b & 0x80) {
+			delta |= (uint32_t) (*b++ & 0x7F) << shift;
+			shift += 7;
+		}
+		delta |= (uint32_t) *b++ << shift;
+		doc += delta;
+		c->buf[k] = doc;
+	}
+}
+
+static void cursor_init(cursor_t *c, const my_str_posting_t *p) {
+	c->p = p;
+	cursor_load(c, 0);
+}
+
+//! Перейти до першого документа >= target (курсор лише рухається вперед).
+//! Спершу галопом по першим документам блоків, потім галопом у блоці.
+//! Повертає 1 і документ у doc, 0 -- список вичерпано.
+static int cursor_seek(cursor_t *c, uint32_t target, uint32_t *doc) {
+	const my_str_posting_t *p = c->p;
+	if (c->buf[c->n - 1] < target) {
+		size_t lo = c->block;
+		size_t step = 1;
+		size_t hi = lo + 1;
+		while (hi < p->nskips && p->skips[hi].first <= target) {
+			lo = hi;
+			hi += step;
+			step *= 2;
+		}
+		if (hi > p->nskips) {
+			hi = p->nskips;
+		}
+		// Останній блок, що починається не пізніше target, -- у [lo, hi).
+		while (hi - lo > 1) {
+			size_t mid = lo + (hi - lo) / 2;
+			if (p->skips[mid].first <= target) {
+				lo = mid;
+			} else {
+				hi = mid;
+			}
+		}
+		if (lo != c->block) {
+			cursor_load(c, lo);
+		}
+		if (c->buf[c->n - 1] < target) {
+			if (c->block + 1 >= p->nskips) {
+				c->i = c->n;
+				return 0;
+			}
+			cursor_load(c, c->block + 1);
+		}
+	}
+	size_t lo = c->i;
+	size_t step = 1;
+	size_t hi = lo;
+	while (hi < c->n && c->buf[hi] < target) {
+		lo = hi + 1;
+		hi += step;
+		step *= 2;
+	}
+	if (hi > c->n) {
+		hi = c->n;
+	}
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (c->buf[mid] < target) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	c->i = lo;
+	*doc = c->buf[lo];
+	return 1;
+}
+
+//!===========================================================================
+//! Словник термінів
+//!===========================================================================
+
+static size_t term_find(const my_str_invidx_t *idx, my_str_view_t term, uint64_t hash) {
+	for (size_t s = (size_t) hash & idx->table_mask;; s = (s + 1) & idx->table_mask) {
+		uint32_t e = idx->table[s];
+		if (e == 0) {
+			return NOT_FOUND;
+		}
+		if (idx->hashes[e - 1] == hash && my_str_view_eq(my_str_vec_get(&idx->terms, e - 1), term)) {
+			return e - 1;
+		}
+	}
+}
+
+static void table_put(uint32_t *table, size_t mask, uint64_t hash, uint32_t id) {
+	size_t s = (size_t) hash & mask;
+	while (table[s] != 0) {
+		s = (s + 1) & mask;
+	}
+	table[s] = id + 1;
+}
+
+static size_t term_insert(my_str_invidx_t *idx, my_str_view_t term, uint64_t hash) {
+	size_t id = my_str_vec_size(&idx->terms);
+	if (2 * (id + 1) > idx->table_mask + 1) {
+		size_t size = 2 * (idx->table_mask + 1);
+		uint32_t *table = calloc(size, sizeof(uint32_t));
+		if (table == NULL) {
+			return NOT_FOUND;
+		}
+		for (size_t i = 0; i < id; i++) {
+			table_put(table, size - 1, idx->hashes[i], (uint32_t) i);
+		}
+		free(idx->table);
+		idx->table = table;
+		idx->table_mask = size - 1;
+	}
+	if (id == idx->cap_terms) {
+		size_t cap = idx->cap_terms * 2;
+		uint64_t *hashes = realloc(idx->hashes, sizeof(uint64_t) * cap);
+		if (hashes == NULL) {
+			return NOT_FOUND;
+		}
+		idx->hashes = hashes;
+		my_str_posting_t *postings = realloc(idx->postings, sizeof(my_str_posting_t) * cap);
+		if (postings == NULL) {
+			return NOT_FOUND;
+		}
+		idx->postings = postings;
+		idx->cap_terms = cap;
+	}
+	if (my_str_vec_push(&idx->terms, term) != 0) {
+		return NOT_FOUND;
+	}
+	idx->hashes[id] = hash;
+	memset(&idx->postings[id], 0, sizeof(my_str_posting_t));
+	table_put(idx->table, idx->table_mask, hash, (uint32_t) id);
+	return id;
+}
+
+//! Створити порожній індекс. Після використання -- викличте my_str_invidx_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_invidx_create(my_str_invidx_t *idx) {
+	if (idx == NULL) {
+		return -1;
+	}
+	memset(idx, 0, sizeof(*idx));
+	idx->cap_terms = 64;
+	idx->table_mask = 127;
+	idx->hashes = malloc(sizeof(uint64_t) * idx->cap_terms);
+	idx->postings = malloc(sizeof(my_str_posting_t) * idx->cap_terms);
+	idx->table = calloc(idx->table_mask + 1, sizeof(uint32_t));
+	if (my_str_vec_create(&idx->terms, idx->cap_terms) != 0 || idx->hashes == NULL ||
+		idx->postings == NULL || idx->table == NULL) {
+		my_str_invidx_free(idx);
+		return -2;
+	}
+	return 0;
+}
+
+void my_str_invidx_free(my_str_invidx_t *idx) {
+	if (idx == NULL) {
+		return;
+	}
+	size_t n = my_str_vec_size(&idx->terms);
+	for (size_t i = 0; i < n && idx->postings != NULL; i++) {
+		free(idx->postings[i].bytes);
+		free(idx->postings[i].skips);
+	}
+	my_str_vec_free(&idx->terms);
+	free(idx->hashes);
+	free(idx->postings);
+	free(idx->table);
+	memset(idx, 0, sizeof(*idx));
+}
+
+//! Додати документ у кінець індексу: терміни -- поля my_str_split
+//! з роздільниками-символами delims. Номер документа -- в doc_id (якщо не NULL).
+//! Документи нумеруються підряд з 0, тож списки лише дописуються.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять,
+//! -3 -- забагато документів, 0 -- все ОК.
+int my_str_invidx_add(my_str_invidx_t *idx, my_str_view_t doc, const char *delims, uint32_t *doc_id) {
+	if (idx == NULL || delims == NULL) {
+		return -1;
+	}
+	if (idx->ndocs == UINT32_MAX) {
+		return -3;
+	}
+	uint32_t id = idx->ndocs++;
+	my_str_split_iter_t it;
+	my_str_view_t term;
+	my_str_split_init_set(&it, doc, delims, MY_STR_SPLIT_SKIP_EMPTY);
+	while (my_str_split_next(&it, &term) == 1) {
+		uint64_t hash = my_str_hash(term);
+		size_t t = term_find(idx, term, hash);
+		if (t == NOT_FOUND) {
+			t = term_insert(idx, term, hash);
+			if (t == NOT_FOUND) {
+				return -2;
+			}
+		}
+		my_str_posting_t *p = &idx->postings[t];
+		if (p->count > 0 && p->last == id) {
+			continue;
+		}
+		if (posting_append(p, id) != 0) {
+			return -2;
+		}
+	}
+	if (doc_id != NULL) {
+		*doc_id = id;
+	}
+	return 0;
+}
+
+//! my_str_invidx_add() для my_str_t.
+int my_str_invidx_add_str(my_str_invidx_t *idx, const my_str_t *doc, const char *delims, uint32_t *doc_id) {
+	if (doc == NULL) {
+		return -1;
+	}
+	return my_str_invidx_add(idx, my_str_view(doc), delims, doc_id);
+}
+
+//! Кількість документів, що містять term.
+size_t my_str_invidx_doc_count(const my_str_invidx_t *idx, my_str_view_t term) {
+	size_t t = term_find(idx, term, my_str_hash(term));
+	return t == NOT_FOUND ? 0 : idx->postings[t].count;
+}
+
+//!===========================================================================
+//! Запити
+//!===========================================================================
+
+void my_str_invidx_result_init(my_str_invidx_result_t *res) {
+	res->docs = NULL;
+	res->size_m = 0;
+	res->capacity_m = 0;
+}
+
+void my_str_invidx_result_free(my_str_invidx_result_t *res) {
+	free(res->docs);
+	my_str_invidx_result_init(res);
+}
+
+static int result_push(my_str_invidx_result_t *res, uint32_t doc) {
+	if (res->size_m == res->capacity_m) {
+		size_t cap = res->capacity_m ? res->capacity_m * 2 : 64;
+		uint32_t *docs = realloc(res->docs, sizeof(uint32_t) * cap);
+		if (docs == NULL) {
+			return -2;
+		}
+		res->docs = docs;
+		res->capacity_m = cap;
+	}
+	res->docs[res->size_m++] = doc;
+	return 0;
+}
+
+static int posting_cmp(const void *a, const void *b) {
+	const my_str_posting_t *x = *(const my_str_posting_t *const *) a;
+	const my_str_posting_t *y = *(const my_str_posting_t *const *) b;
+	return x->count < y->count ? -1 : x->count > y->count;
+}
+
+//! Документи, що містять усі терміни (результат у res замінюється).
+//! Перетин "чехардою": найкоротший список веде, решта курсорів
+//! доганяють його галопом по блоках і всередині блоку.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_invidx_and(const my_str_invidx_t *idx, const my_str_view_t *terms, size_t n, my_str_invidx_result_t *res) {
+	if (idx == NULL || res == NULL || (terms == NULL && n > 0)) {
+		return -1;
+	}
+	res->size_m = 0;
+	if (n == 0) {
+		return 0;
+	}
+	const my_str_posting_t **lists = malloc(sizeof(*lists) * n);
+	cursor_t *cur = malloc(sizeof(*cur) * n);
+	if (lists == NULL || cur == NULL) {
+		free(lists);
+		free(cur);
+		return -2;
+	}
+	int rc = 0;
+	for (size_t i = 0; i < n; i++) {
+		size_t t = term_find(idx, terms[i], my_str_hash(terms[i]));
+		if (t == NOT_FOUND) {
+			goto out;
+		}
+		lists[i] = &idx->postings[t];
+	}
+	qsort(lists, n, sizeof(*lists), posting_cmp);
+	for (size_t i = 0; i < n; i++) {
+		cursor_init(&cur[i], lists[i]);
+	}
+	uint32_t target = 0;
+	uint32_t doc;
+	while (cursor_seek(&cur[0], target, &doc)) {
+		int all = 1;
+		for (size_t i = 1; i < n; i++) {
+			uint32_t other;
+			if (!cursor_seek(&cur[i], doc, &other)) {
+				goto out;
+			}
+			if (other != doc) {
+				target = other;
+				all = 0;
+				break;
+			}
+		}
+		if (all) {
+			if (result_push(res, doc) != 0) {
+				rc = -2;
+				goto out;
+			}
+			if (doc == UINT32_MAX) {
+				break;
+			}
+			target = doc + 1;
+		}
+	}
+out:
+	free(cur);
+	free(lists);
+	return rc;
+}
+
+static int doc_cmp(const void *a, const void *b) {
+	uint32_t x = *(const uint32_t *) a;
+	uint32_t y = *(const uint32_t *) b;
+	return x < y ? -1 : x > y;
+}
+
+//! Документи, що містять хоч один із термінів (результат у res замінюється).
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_invidx_or(const my_str_invidx_t *idx, const my_str_view_t *terms, size_t n, my_str_invidx_result_t *res) {
+	if (idx == NULL || res == NULL || (terms == NULL && n > 0)) {
+		return -1;
+	}
+	res->size_m = 0;
+	size_t lists = 0;
+	for (size_t i = 0; i < n; i++) {
+		size_t t = term_find(idx, terms[i], my_str_hash(terms[i]));
+		if (t == NOT_FOUND) {
+			continue;
+		}
+		cursor_t c;
+		cursor_init(&c, &idx->postings[t]);
+		for (;;) {
+			for (size_t k = 0; k < c.n; k++) {
+				if (result_push(res, c.buf[k]) != 0) {
+					return -2;
+				}
+			}
+			if (c.block + 1 >= c.p->nskips) {
+				break;
+			}
+			cursor_load(&c, c.block + 1);
+		}
+		lists++;
+	}
+	if (lists > 1) {
+		qsort(res->docs, res->size_m, sizeof(uint32_t), doc_cmp);
+		size_t w = 0;
+		for (size_t r = 0; r < res->size_m; r++) {
+			if (w == 0 || res->docs[w - 1] != res->docs[r]) {
+				res->docs[w++] = res->docs[r];
+			}
+		}
+		res->size_m = w;
+	}
+	return 0;
+}
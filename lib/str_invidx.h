@@ -0,0 +1,61 @@
+#ifndef STRLIB_INVIDX_H
+#define STRLIB_INVIDX_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+#include "str_vec.h"
+
+#define MY_STR_INVIDX_BLOCK 128 // Документів у блоці списку
+
+//! Початок блоку списку документів: для пропуску блоків при перетині.
+typedef struct
+{
+	uint32_t first;	 // Перший документ блоку
+	uint32_t offset; // Зсув блоку в bytes
+} my_str_invidx_skip_t;
+
+//! Стиснений список документів одного терміна: різниці номерів у varint,
+//! блоками по MY_STR_INVIDX_BLOCK, перший документ блоку -- в skips.
+typedef struct
+{
+	uint8_t* bytes;
+	size_t size_m;
+	size_t capacity_m;
+	my_str_invidx_skip_t* skips;
+	size_t nskips;
+	size_t cap_skips;
+	uint32_t count;	 // Кількість документів
+	uint32_t last;	 // Останній доданий документ
+} my_str_posting_t;
+
+typedef struct
+{
+	my_str_vec_t terms;		   // Термін i -- його текст
+	uint64_t* hashes;		   // Хеш терміна i
+	my_str_posting_t* postings; // Список документів терміна i
+	size_t cap_terms;
+	uint32_t* table;		   // Хеш -> номер терміна + 1 (0 -- порожньо)
+	size_t table_mask;
+	uint32_t ndocs;			   // Кількість документів (і номер наступного)
+} my_str_invidx_t;
+
+//! Результат запиту -- номери документів за зростанням.
+typedef struct
+{
+	uint32_t* docs;
+	size_t size_m;
+	size_t capacity_m;
+} my_str_invidx_result_t;
+
+int my_str_invidx_create(my_str_invidx_t* idx);
+void my_str_invidx_free(my_str_invidx_t* idx);
+int my_str_invidx_add(my_str_invidx_t* idx, my_str_view_t doc, const char* delims, uint32_t* doc_id);
+int my_str_invidx_add_str(my_str_invidx_t* idx, const my_str_t* doc, const char* delims, uint32_t* doc_id);
+size_t my_str_invidx_doc_count(const my_str_invidx_t* idx, my_str_view_t term);
+
+void my_str_invidx_result_init(my_str_invidx_result_t* res);
+void my_str_invidx_result_free(my_str_invidx_result_t* res);
+int my_str_invidx_and(const my_str_invidx_t* idx, const my_str_view_t* terms, size_t n, my_str_invidx_result_t* res);
+int my_str_invidx_or(const my_str_invidx_t* idx, const my_str_view_t* terms, size_t n, my_str_invidx_result_t* res);
+#endif //STRLIB_INVIDX_H
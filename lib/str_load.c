@@ -0,0 +1,470 @@
+//
+// Пакетне завантаження багатьох невеликих файлів.
+//
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "str_load.h"
+
+#ifdef MY_STR_HAVE_IO_URING
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+//! Коди стану окремого файлу.
+#define LOAD_OK 0
+#define LOAD_OPEN_FAILED (-2)
+#define LOAD_READ_FAILED (-3)
+#define LOAD_NO_MEMORY (-4)
+#define LOAD_PENDING 1 // Результату ще немає
+
+//! Підготувати стрічку під size байт вмісту.
+static int load_reserve(my_str_t *str, size_t size) {
+	str->size_m = 0;
+	if (size > str->capacity_m) {
+		my_str_reserve(str, size);
+		if (str->data == NULL || str->capacity_m < size) {
+			return LOAD_NO_MEMORY;
+		}
+	}
+	return LOAD_OK;
+}
+
+//!===========================================================================
+//! Запасний варіант: синхронне читання на потоках пулу
+//!===========================================================================
+
+struct load_state {
+	const char *const *paths;
+	my_str_t *strs;
+	int *status;
+};
+
+static int load_one(const char *path, my_str_t *str) {
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return LOAD_OPEN_FAILED;
+	}
+	struct stat st;
+	int rc = fstat(fd, &st) == 0 ? load_reserve(str, (size_t) st.st_size) : LOAD_OPEN_FAILED;
+	size_t done = 0;
+	while (rc == LOAD_OK && done < (size_t) st.st_size) {
+		ssize_t n = pread(fd, str->data + done, (size_t) st.st_size - done, (off_t) done);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n < 0) {
+			rc = LOAD_READ_FAILED;
+		} else if (n == 0) {
+			break;
+		}
+		done += n > 0 ? (size_t) n : 0;
+	}
+	str->size_m = rc == LOAD_OK ? done : 0;
+	close(fd);
+	return rc;
+}
+
+static void load_task(size_t index, size_t worker, void *arg) {
+	(void) worker;
+	struct load_state *st = arg;
+	st->status[index] = load_one(st->paths[index], &st->strs[index]);
+}
+
+static int load_with_pool(my_str_pool_t *pool, const char *const *paths, size_t count, my_str_t *strs, int *status) {
+	my_str_pool_t own;
+	if (pool == NULL) {
+		if (my_str_pool_create(&own, 0) != 0) {
+			return -3;
+		}
+		pool = &own;
+	}
+	struct load_state st = {paths, strs, status};
+	my_str_pool_run(pool, count, load_task, &st);
+	if (pool == &own) {
+		my_str_pool_free(&own);
+	}
+	return 0;
+}
+
+//!===========================================================================
+//! io_uring: відкриття, statx, читання та закриття -- без блокування
+//!===========================================================================
+
+#ifdef MY_STR_HAVE_IO_URING
+
+#define URING_ENTRIES 256
+
+enum { OP_OPEN, OP_STATX, OP_READ, OP_CLOSE };
+static const __u8 uring_opcodes[] = {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_CLOSE};
+
+struct uring {
+	int fd;
+	unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+	unsigned *cq_head, *cq_tail, *cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sq_ptr, *cq_ptr;
+	size_t sq_len, cq_len, sqes_len;
+	unsigned entries;
+	unsigned sq_local_tail;
+	unsigned to_submit;
+};
+
+//! Файл "у польоті": одночасно їх не більше entries / 2,
+//! тож операцій у черзі ніколи не більше за її розмір.
+struct uring_slot {
+	size_t index;	 // Номер файлу
+	int busy;		 // Слот зайнятий файлом
+	int fd;
+	int pending;	 // Незавершені open + statx
+	int err;
+	size_t size;
+	size_t done;
+	struct statx stx;
+};
+
+static int uring_setup(struct uring *ring, unsigned entries) {
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	memset(ring, 0, sizeof(*ring));
+	ring->fd = (int) syscall(__NR_io_uring_setup, entries, &p);
+	if (ring->fd < 0) {
+		return -1;
+	}
+	// OPENAT, STATX, READ та CLOSE з'явилися разом із RW_CUR_POS (5.6).
+	if (!(p.features & IORING_FEAT_RW_CUR_POS)) {
+		close(ring->fd);
+		return -1;
+	}
+	ring->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	ring->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring->cq_len > ring->sq_len) {
+			ring->sq_len = ring->cq_len;
+		}
+		ring->cq_len = ring->sq_len;
+	}
+	ring->sq_ptr = mmap(NULL, ring->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	if (ring->sq_ptr == MAP_FAILED) {
+		close(ring->fd);
+		return -1;
+	}
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		ring->cq_ptr = ring->sq_ptr;
+	} else {
+		ring->cq_ptr = mmap(NULL, ring->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+		if (ring->cq_ptr == MAP_FAILED) {
+			munmap(ring->sq_ptr, ring->sq_len);
+			close(ring->fd);
+			return -1;
+		}
+	}
+	ring->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED) {
+		if (ring->cq_ptr != ring->sq_ptr) {
+			munmap(ring->cq_ptr, ring->cq_len);
+		}
+		munmap(ring->sq_ptr, ring->sq_len);
+		close(ring->fd);
+		return -1;
+	}
+	char *sq = ring->sq_ptr;
+	char *cq = ring->cq_ptr;
+	ring->sq_head = (unsigned *) (sq + p.sq_off.head);
+	ring->sq_tail = (unsigned *) (sq + p.sq_off.tail);
+	ring->sq_mask = (unsigned *) (sq + p.sq_off.ring_mask);
+	ring->sq_array = (unsigned *) (sq + p.sq_off.array);
+	ring->cq_head = (unsigned *) (cq + p.cq_off.head);
+	ring->cq_tail = (unsigned *) (cq + p.cq_off.tail);
+	ring->cq_mask = (unsigned *) (cq + p.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *) (cq + p.cq_off.cqes);
+	ring->entries = p.sq_entries;
+	ring->sq_local_tail = *ring->sq_tail;
+	return 0;
+}
+
+static void uring_free(struct uring *ring) {
+	munmap(ring->sqes, ring->sqes_len);
+	if (ring->cq_ptr != ring->sq_ptr) {
+		munmap(ring->cq_ptr, ring->cq_len);
+	}
+	munmap(ring->sq_ptr, ring->sq_len);
+	close(ring->fd);
+}
+
+//! Наступний вільний запис черги подання (місце гарантоване лімітом слотів).
+static struct io_uring_sqe *uring_sqe(struct uring *ring, int op, size_t slot) {
+	unsigned idx = ring->sq_local_tail & *ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[idx];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = uring_opcodes[op];
+	sqe->user_data = (__u64) slot << 2 | (__u64) op;
+	ring->sq_array[idx] = idx;
+	ring->sq_local_tail++;
+	__atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+	ring->to_submit++;
+	return sqe;
+}
+
+static int uring_enter(struct uring *ring, unsigned wait_nr) {
+	for (;;) {
+		int n = (int) syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, wait_nr, IORING_ENTER_GETEVENTS, NULL, 0);
+		if (n >= 0) {
+			ring->to_submit -= (unsigned) n < ring->to_submit ? (unsigned) n : ring->to_submit;
+			return 0;
+		}
+		if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+			return -1;
+		}
+	}
+}
+
+static void uring_read(struct uring *ring, struct uring_slot *s, size_t slot, my_str_t *str) {
+	struct io_uring_sqe *sqe = uring_sqe(ring, OP_READ, slot);
+	sqe->fd = s->fd;
+	sqe->addr = (__u64) (uintptr_t) (str->data + s->done);
+	sqe->len = (__u32) (s->size - s->done > 0x7ffff000u ? 0x7ffff000u : s->size - s->done);
+	sqe->off = s->done;
+}
+
+static void uring_close(struct uring *ring, struct uring_slot *s, size_t slot) {
+	struct io_uring_sqe *sqe = uring_sqe(ring, OP_CLOSE, slot);
+	sqe->fd = s->fd;
+}
+
+//! Почати завантаження файлу index у слот: open та statx паралельно.
+static void uring_start(struct uring *ring, struct uring_slot *s, size_t slot, size_t index, const char *path) {
+	memset(s, 0, sizeof(*s));
+	s->index = index;
+	s->busy = 1;
+	s->fd = -1;
+	s->pending = 2;
+	struct io_uring_sqe *sqe = uring_sqe(ring, OP_OPEN, slot);
+	sqe->fd = AT_FDCWD;
+	sqe->addr = (__u64) (uintptr_t) path;
+	sqe->open_flags = O_RDONLY | O_CLOEXEC;
+	sqe = uring_sqe(ring, OP_STATX, slot);
+	sqe->fd = AT_FDCWD;
+	sqe->addr = (__u64) (uintptr_t) path;
+	sqe->len = STATX_SIZE;
+	sqe->off = (__u64) (uintptr_t) &s->stx;
+}
+
+//! Повертає 1, якщо слот звільнився.
+static int uring_complete(struct uring *ring, struct uring_slot *slots, const struct io_uring_cqe *cqe,
+						  my_str_t *strs, int *status) {
+	size_t slot = (size_t) (cqe->user_data >> 2);
+	struct uring_slot *s = &slots[slot];
+	my_str_t *str = &strs[s->index];
+	switch ((int) (cqe->user_data & 3)) {
+	case OP_OPEN:
+	case OP_STATX:
+		if (cqe->res < 0) {
+			s->err = LOAD_OPEN_FAILED;
+		} else if ((cqe->user_data & 3) == OP_OPEN) {
+			s->fd = cqe->res;
+		} else {
+			s->size = (size_t) s->stx.stx_size;
+		}
+		if (--s->pending > 0) {
+			return 0;
+		}
+		if (s->err == LOAD_OK) {
+			s->err = load_reserve(str, s->size);
+		}
+		if (s->fd < 0) {
+			break;
+		}
+		if (s->err == LOAD_OK && s->size > 0) {
+			uring_read(ring, s, slot, str);
+		} else {
+			uring_close(ring, s, slot);
+		}
+		return 0;
+	case OP_READ:
+		if (cqe->res < 0) {
+			s->err = LOAD_READ_FAILED;
+		} else if (cqe->res > 0) {
+			s->done += (size_t) cqe->res;
+			if (s->done < s->size) {
+				uring_read(ring, s, slot, str);
+				return 0;
+			}
+		}
+		uring_close(ring, s, slot);
+		return 0;
+	default:
+		s->fd = -1;
+		break;
+	}
+	str->size_m = s->err == LOAD_OK ? s->done : 0;
+	status[s->index] = s->err;
+	s->busy = 0;
+	return 1;
+}
+
+//! Кільце зламалося: нових операцій не подавати, але дочекатися всіх,
+//! які ядро вже забрало з черги (sq_start -- хвіст черги на старті,
+//! reaped -- скільки завершень уже оброблено), бо вони пишуть у слоти
+//! та стрічки. Потім закрити відкриті файли; результату слоти не записують.
+//! -1 -- дочекатися не вдалося.
+static int uring_drain(struct uring *ring, struct uring_slot *slots, size_t nslots, unsigned sq_start, unsigned reaped) {
+	for (;;) {
+		unsigned head = *ring->cq_head;
+		unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+		for (; head != tail; head++, reaped++) {
+			const struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+			struct uring_slot *s = &slots[cqe->user_data >> 2];
+			if ((cqe->user_data & 3) == OP_OPEN && cqe->res >= 0) {
+				s->fd = cqe->res;
+			} else if ((cqe->user_data & 3) == OP_CLOSE) {
+				s->fd = -1;
+			}
+		}
+		__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+		unsigned consumed = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) - sq_start;
+		if (consumed == reaped) {
+			break;
+		}
+		if (syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+			errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+			return -1;
+		}
+	}
+	for (size_t i = 0; i < nslots; i++) {
+		if (slots[i].busy && slots[i].fd >= 0) {
+			close(slots[i].fd);
+			slots[i].fd = -1;
+		}
+	}
+	return 0;
+}
+
+//! -1 -- io_uring недоступний (нічого не зроблено), 0 -- все ОК.
+static int load_with_uring(const char *const *paths, size_t count, my_str_t *strs, int *status) {
+	struct uring ring;
+	if (uring_setup(&ring, URING_ENTRIES) != 0) {
+		return -1;
+	}
+	size_t nslots = ring.entries / 2;
+	struct uring_slot *slots = calloc(nslots, sizeof(*slots));
+	size_t *free_slots = malloc(sizeof(size_t) * nslots);
+	if (slots == NULL || free_slots == NULL) {
+		free(slots);
+		free(free_slots);
+		uring_free(&ring);
+		return -1;
+	}
+	size_t nfree = nslots;
+	for (size_t i = 0; i < nslots; i++) {
+		free_slots[i] = nslots - 1 - i;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		status[i] = LOAD_PENDING;
+	}
+	unsigned sq_start = ring.sq_local_tail;
+	unsigned reaped = 0;
+	size_t next = 0;
+	size_t finished = 0;
+	int rc = 0;
+	while (finished < count) {
+		while (next < count && nfree > 0) {
+			size_t slot = free_slots[--nfree];
+			uring_start(&ring, &slots[slot], slot, next, paths[next]);
+			next++;
+		}
+		if (uring_enter(&ring, 1) != 0) {
+			rc = -1;
+			break;
+		}
+		unsigned head = *ring.cq_head;
+		unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+		for (; head != tail; head++, reaped++) {
+			const struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+			if (uring_complete(&ring, slots, cqe, strs, status)) {
+				free_slots[nfree++] = (size_t) (cqe->user_data >> 2);
+				finished++;
+			}
+		}
+		__atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+	}
+
+	if (rc != 0 && uring_drain(&ring, slots, nslots, sq_start, reaped) != 0) {
+		// Ядро ще може писати у слоти і стрічки файлів у польоті: слоти
+		// лишаються невивільненими, а ці файли -- непрочитаними.
+		for (size_t i = 0; i < nslots; i++) {
+			if (slots[i].busy) {
+				status[slots[i].index] = LOAD_READ_FAILED;
+			}
+		}
+		slots = NULL;
+	}
+	free(free_slots);
+	free(slots);
+	uring_free(&ring);
+	// Кільце зламалося посередині -- решту, зокрема файли, що були
+	// в польоті, дочитати синхронно.
+	if (rc != 0) {
+		for (size_t i = 0; i < count; i++) {
+			if (status[i] == LOAD_PENDING) {
+				status[i] = load_one(paths[i], &strs[i]);
+			}
+		}
+	}
+	return 0;
+}
+
+#endif // MY_STR_HAVE_IO_URING
+
+//! Завантажити вміст count файлів paths у стрічки strs
+//! (кожну заздалегідь створено через my_str_create(), старий вміст замінюється).
+//! Через io_uring, якщо він доступний: багато відкриттів і читань одночасно
+//! в польоті, без потоку на кожен файл. Інакше (чи з MY_STR_LOAD_NO_URING) --
+//! синхронне читання на потоках pool (NULL -- тимчасовий пул на всі ядра).
+//! status, якщо не NULL, отримує для кожного файлу: 0 -- все ОК,
+//! -2 -- не вдалося відкрити, -3 -- помилка читання, -4 -- не вистачило пам'яті.
+//! Повертає 0, якщо всі файли прочитано, -1 -- некоректні аргументи,
+//! -2 -- хоч один файл не прочитано чи не вистачило пам'яті, -3 -- не вдалося створити потоки.
+int my_str_load_files(my_str_pool_t *pool, const char *const *paths, size_t count, my_str_t *strs, int *status, int flags) {
+	if ((paths == NULL || strs == NULL) && count > 0) {
+		return -1;
+	}
+	if (count == 0) {
+		return 0;
+	}
+	int *own_status = NULL;
+	if (status == NULL) {
+		status = own_status = malloc(sizeof(int) * count);
+		if (status == NULL) {
+			return -2;
+		}
+	}
+
+	int rc = -1;
+#ifdef MY_STR_HAVE_IO_URING
+	if (!(flags & MY_STR_LOAD_NO_URING)) {
+		rc = load_with_uring(paths, count, strs, status);
+	}
+#else
+	(void) flags;
+#endif
+	if (rc != 0) {
+		rc = load_with_pool(pool, paths, count, strs, status);
+	}
+	for (size_t i = 0; i < count && rc == 0; i++) {
+		if (status[i] != LOAD_OK) {
+			rc = -2;
+		}
+	}
+	free(own_status);
+	return rc;
+}
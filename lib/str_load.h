@@ -0,0 +1,10 @@
+#ifndef STRLIB_LOAD_H
+#define STRLIB_LOAD_H
+#include <stdio.h>
+#include "stringg.h"
+#include "str_parallel.h"
+
+#define MY_STR_LOAD_NO_URING 1 // Не пробувати io_uring, одразу пул потоків
+
+int my_str_load_files(my_str_pool_t* pool, const char* const* paths, size_t count, my_str_t* strs, int* status, int flags);
+#endif //STRLIB_LOAD_H
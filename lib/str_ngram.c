@@ -0,0 +1,169 @@
+//
+// Символьні та словесні n-грами з ковзним 64-бітним хешем.
+//
+#include <string.h>
+#include "str_ngram.h"
+
+#define BASE 0x100000001B3ull
+
+//! Перемішування виходу: поліноміальний хеш має слабкі молодші біти,
+//! а хеш-таблиці беруть саме їх. На ковзання не впливає -- лише на результат.
+static uint64_t finalize(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDull;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+static int ngram_init(my_str_ngram_iter_t *it, my_str_view_t text, size_t n, int words, int flags) {
+	if (it == NULL || n == 0 || n > MY_STR_NGRAM_MAX) {
+		return -1;
+	}
+	memset(it, 0, sizeof(*it));
+	it->text = text;
+	it->n = n;
+	it->words = words;
+	it->flags = flags;
+	it->pow = 1;
+	for (size_t i = 1; i < n; i++) {
+		it->pow *= BASE;
+	}
+	return 0;
+}
+
+//! N-грами з n символів (байтів, або кодових точок з MY_STR_NGRAM_UTF8).
+//! -1 -- нульовий вказівник чи n поза [1, MY_STR_NGRAM_MAX], 0 -- все ОК.
+int my_str_ngram_init_chars(my_str_ngram_iter_t *it, my_str_view_t text, size_t n, int flags) {
+	return ngram_init(it, text, n, 0, flags);
+}
+
+//! N-грами з n слів; слова -- поля my_str_split з роздільниками-символами delims.
+//! Хеш залежить лише від слів, не від роздільників між ними.
+int my_str_ngram_init_words(my_str_ngram_iter_t *it, my_str_view_t text, size_t n, const char *delims) {
+	int rc = ngram_init(it, text, n, 1, 0);
+	if (rc == 0) {
+		my_str_split_init_set(&it->split, text, delims, MY_STR_SPLIT_SKIP_EMPTY);
+		it->sep = delims != NULL && delims[0] != '\0' ? delims[0] : ' ';
+	}
+	return rc;
+}
+
+//! Наступна одиниця (символ чи слово): значення для хешу та її межі.
+static int next_unit(my_str_ngram_iter_t *it, uint64_t *unit, size_t *beg, size_t *end) {
+	if (it->words) {
+		my_str_view_t word;
+		if (my_str_split_next(&it->split, &word) != 1) {
+			return 0;
+		}
+		*unit = my_str_hash(word);
+		*beg = (size_t) (word.data - it->text.data);
+		*end = *beg + word.size_m;
+		return 1;
+	}
+	const unsigned char *p = (const unsigned char *) it->text.data;
+	if (it->pos >= it->text.size_m) {
+		return 0;
+	}
+	*beg = it->pos;
+	uint64_t u = p[it->pos++];
+	if (it->flags & MY_STR_NGRAM_UTF8) {
+		while (it->pos < it->text.size_m && (p[it->pos] & 0xC0) == 0x80) {
+			u = u << 8 | p[it->pos++];
+		}
+	}
+	*unit = u + 1;
+	*end = it->pos;
+	return 1;
+}
+
+//! Наступна n-грама. Погляд -- від початку першої одиниці до кінця останньої.
+//! Повертає 1 -- n-грама є, 0 -- закінчилися, -1 -- нульовий вказівник.
+int my_str_ngram_next(my_str_ngram_iter_t *it, my_str_ngram_t *gram) {
+	if (it == NULL || gram == NULL) {
+		return -1;
+	}
+	uint64_t unit;
+	size_t beg;
+	size_t end;
+	while (next_unit(it, &unit, &beg, &end)) {
+		size_t slot;
+		if (it->fill == it->n) {
+			// Вікно повне: прибрати найстарішу одиницю, її місце займе нова.
+			slot = it->head;
+			it->hash -= it->units[slot] * it->pow;
+			it->head = (it->head + 1) % it->n;
+		} else {
+			slot = (it->head + it->fill) % it->n;
+			it->fill++;
+		}
+		it->hash = it->hash * BASE + unit;
+		it->units[slot] = unit;
+		it->starts[slot] = beg;
+		it->ends[slot] = end;
+		if (it->fill == it->n) {
+			gram->hash = finalize(it->hash);
+			gram->view = my_str_view_sub(it->text, it->starts[it->head], end);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+//! Ключ словесної n-грами, що відповідає її хешу: слова через it->sep.
+//! Якщо ділянка тексту вже така -- вона сама, інакше ключ збирається в buf.
+static int word_key(const my_str_ngram_iter_t *it, my_str_view_t view, my_str_t *buf, my_str_view_t *key) {
+	size_t len = it->n - 1;
+	int same = 1;
+	for (size_t k = 0; k < it->n; k++) {
+		size_t slot = (it->head + k) % it->n;
+		len += it->ends[slot] - it->starts[slot];
+		if (k > 0 && (it->starts[slot] != it->ends[(slot + it->n - 1) % it->n] + 1 ||
+					  it->text.data[it->starts[slot] - 1] != it->sep)) {
+			same = 0;
+		}
+	}
+	if (same) {
+		*key = view;
+		return 0;
+	}
+	if (len > buf->capacity_m && my_str_reserve(buf, len) != 0) {
+		return -2;
+	}
+	buf->size_m = 0;
+	for (size_t k = 0; k < it->n; k++) {
+		size_t slot = (it->head + k) % it->n;
+		if (k > 0) {
+			buf->data[buf->size_m++] = it->sep;
+		}
+		memcpy(buf->data + buf->size_m, it->text.data + it->starts[slot], it->ends[slot] - it->starts[slot]);
+		buf->size_m += it->ends[slot] - it->starts[slot];
+	}
+	*key = my_str_view(buf);
+	return 0;
+}
+
+//! Додати всі n-грами ітератора до лічильника найчастіших, з уже готовим хешем.
+//! Усі n-грами одного лічильника мають іти від ітераторів одного виду.
+//! Ключ словесної n-грами -- її слова через перший символ delims, тож
+//! "a b" і "a  b" -- одна й та сама n-грама, як і за хешем.
+//! Повертає коди помилок my_str_topk_add_hashed().
+int my_str_ngram_to_topk(my_str_ngram_iter_t *it, my_str_topk_t *topk) {
+	my_str_ngram_t gram;
+	my_str_t buf = {0, 0, NULL};
+	int rc = 0;
+	while (rc == 0 && my_str_ngram_next(it, &gram) == 1) {
+		my_str_view_t key = gram.view;
+		if (it->words) {
+			rc = word_key(it, gram.view, &buf, &key);
+		}
+		if (rc == 0) {
+			rc = my_str_topk_add_hashed(topk, key, gram.hash, 1);
+		}
+	}
+	if (buf.data != NULL) {
+		my_str_free(&buf);
+	}
+	return rc;
+}
@@ -0,0 +1,44 @@
+#ifndef STRLIB_NGRAM_H
+#define STRLIB_NGRAM_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+#include "str_split.h"
+#include "str_topk.h"
+
+#define MY_STR_NGRAM_MAX 32	 // Найбільше n
+#define MY_STR_NGRAM_UTF8 1	 // Символьні n-грами -- по кодових точках UTF-8, а не по байтах
+
+//! Одна n-грама: хеш і погляд на її ділянку тексту.
+typedef struct
+{
+	uint64_t hash;
+	my_str_view_t view;
+} my_str_ngram_t;
+
+//! Ітератор по n-грамах з ковзним хешем: кожна наступна -- за O(1),
+//! без копіювання і без повторного хешування вікна.
+typedef struct
+{
+	my_str_view_t text;
+	size_t n;
+	int words;				// 1 -- n-грами слів, 0 -- символів
+	char sep;				// Роздільник слів у ключах my_str_ngram_to_topk()
+	int flags;
+	size_t pos;				// Наступний непрочитаний байт (для символів)
+	uint64_t hash;			// Поліноміальний хеш вікна
+	uint64_t pow;			// BASE^(n - 1)
+	size_t fill;			// Скільки одиниць у вікні
+	size_t head;			// Найстаріша одиниця вікна в кільцевих буферах
+	uint64_t units[MY_STR_NGRAM_MAX];
+	size_t starts[MY_STR_NGRAM_MAX];
+	size_t ends[MY_STR_NGRAM_MAX];
+	my_str_split_iter_t split;
+} my_str_ngram_iter_t;
+
+int my_str_ngram_init_chars(my_str_ngram_iter_t* it, my_str_view_t text, size_t n, int flags);
+int my_str_ngram_init_words(my_str_ngram_iter_t* it, my_str_view_t text, size_t n, const char* delims);
+int my_str_ngram_next(my_str_ngram_iter_t* it, my_str_ngram_t* gram);
+int my_str_ngram_to_topk(my_str_ngram_iter_t* it, my_str_topk_t* topk);
+#endif //STRLIB_NGRAM_H
@@ -0,0 +1,690 @@
+//
+// Пул потоків та паралельна обробка великих текстів шматками.
+//
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "str_parallel.h"
+#include "str_file.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define MY_STR_CHUNK_DEFAULT (4u << 20)
+#define MY_STR_CACHE_LINE 64
+
+//!===========================================================================
+//! Пул потоків
+//!===========================================================================
+
+//! Кількість доступних ядер, щонайменше 1.
+size_t my_str_cpu_count(void) {
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (size_t) n : 1;
+}
+
+//! Смуги тримаються лічені такти -- досить спін-блокування.
+static void slot_lock(my_str_pool_slot_t *slot) {
+	while (__atomic_exchange_n(&slot->lock, 1, __ATOMIC_ACQUIRE)) {
+		while (__atomic_load_n(&slot->lock, __ATOMIC_RELAXED)) {
+#ifdef __SSE2__
+			_mm_pause();
+#endif
+		}
+	}
+}
+
+static void slot_unlock(my_str_pool_slot_t *slot) {
+	__atomic_store_n(&slot->lock, 0, __ATOMIC_RELEASE);
+}
+
+//! Взяти з діапазону слота шматок спереду (власник) -- спершу великий,
+//! а що менше лишається, то дрібніший: чверть залишку, щонайменше 1.
+static int slot_take(my_str_pool_slot_t *slot, size_t *beg, size_t *end) {
+	slot_lock(slot);
+	size_t left = slot->end - slot->begin;
+	size_t grain = (left + 3) / 4;
+	*beg = slot->begin;
+	*end = slot->begin + grain;
+	__atomic_store_n(&slot->begin, *end, __ATOMIC_RELAXED);
+	slot_unlock(slot);
+	return grain > 0;
+}
+
+//! Забрати в чужого слота задню половину залишку в свій.
+//! Межі пишуться атомарно, щоб порожні смуги відкидати без блокування.
+static int slot_steal(my_str_pool_slot_t *victim, my_str_pool_slot_t *own) {
+	if (__atomic_load_n(&victim->begin, __ATOMIC_RELAXED) >= __atomic_load_n(&victim->end, __ATOMIC_RELAXED)) {
+		return 0;
+	}
+	slot_lock(victim);
+	size_t left = victim->end - victim->begin;
+	size_t mid = victim->end - (left + 1) / 2;
+	size_t end = victim->end;
+	__atomic_store_n(&victim->end, mid, __ATOMIC_RELAXED);
+	slot_unlock(victim);
+	if (mid == end) {
+		return 0;
+	}
+	// Свій слот зараз порожній, і крадуть лише з непорожніх -- ніхто не заважає.
+	slot_lock(own);
+	__atomic_store_n(&own->begin, mid, __ATOMIC_RELAXED);
+	__atomic_store_n(&own->end, end, __ATOMIC_RELAXED);
+	slot_unlock(own);
+	return 1;
+}
+
+//! Виконати свою частку індексів, а тоді красти в інших, поки є що.
+//! Нових індексів під час виконання не з'являється, тож якщо за повний
+//! обхід красти нічого, то решта вже в роботі в інших потоків.
+static void pool_work(my_str_pool_t *pool, size_t worker) {
+	my_str_pool_slot_t *own = &pool->slots[worker];
+	for (;;) {
+		size_t beg;
+		size_t end;
+		while (slot_take(own, &beg, &end)) {
+			for (size_t i = beg; i < end; i++) {
+				pool->fn(i, worker, pool->arg);
+			}
+		}
+		int stolen = 0;
+		for (size_t k = 1; k < pool->threads && !stolen; k++) {
+			stolen = slot_steal(&pool->slots[(worker + k) % pool->threads], own);
+		}
+		if (!stolen) {
+			return;
+		}
+	}
+}
+
+struct pool_thread_arg {
+	my_str_pool_t *pool;
+	size_t worker;
+};
+
+static void *pool_thread(void *raw) {
+	struct pool_thread_arg self = *(struct pool_thread_arg *) raw;
+	free(raw);
+	my_str_pool_t *pool = self.pool;
+	size_t seen = 0;
+	for (;;) {
+		pthread_mutex_lock(&pool->lock);
+		while (pool->generation == seen && !pool->stop) {
+			pthread_cond_wait(&pool->wake, &pool->lock);
+		}
+		if (pool->stop) {
+			pthread_mutex_unlock(&pool->lock);
+			return NULL;
+		}
+		seen = pool->generation;
+		pthread_mutex_unlock(&pool->lock);
+
+		pool_work(pool, self.worker);
+
+		pthread_mutex_lock(&pool->lock);
+		if (--pool->pending == 0) {
+			pthread_cond_signal(&pool->done);
+		}
+		pthread_mutex_unlock(&pool->lock);
+	}
+}
+
+//! Створити пул із threads потоків (0 -- за кількістю ядер).
+//! Потік, що викликає my_str_pool_run(), теж працює, тому фонових на один менше.
+//! Після використання -- викличте my_str_pool_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять,
+//! -3 -- не вдалося створити потік, 0 -- все ОК.
+int my_str_pool_create(my_str_pool_t *pool, size_t threads) {
+	if (pool == NULL) {
+		return -1;
+	}
+	memset(pool, 0, sizeof(*pool));
+	pool->threads = threads ? threads : my_str_cpu_count();
+	pool->handles = malloc(sizeof(pthread_t) * pool->threads);
+	pool->slots = aligned_alloc(MY_STR_CACHE_LINE, sizeof(my_str_pool_slot_t) * pool->threads);
+	if (pool->handles == NULL || pool->slots == NULL) {
+		free(pool->handles);
+		free(pool->slots);
+		pool->handles = NULL;
+		return -2;
+	}
+	memset(pool->slots, 0, sizeof(my_str_pool_slot_t) * pool->threads);
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_mutex_init(&pool->run_lock, NULL);
+	pthread_cond_init(&pool->wake, NULL);
+	pthread_cond_init(&pool->done, NULL);
+	for (size_t w = 1; w < pool->threads; w++) {
+		struct pool_thread_arg *arg = malloc(sizeof(*arg));
+		if (arg != NULL) {
+			arg->pool = pool;
+			arg->worker = w;
+		}
+		if (arg == NULL || pthread_create(&pool->handles[w - 1], NULL, pool_thread, arg) != 0) {
+			free(arg);
+			pool->threads = w;
+			my_str_pool_free(pool);
+			return -3;
+		}
+	}
+	return 0;
+}
+
+//! Викликати fn(i, worker, arg) для всіх i з [0, count) на всіх потоках пулу.
+//! Кожен потік отримує рівну смугу індексів і бере з неї шматки, що
+//! дрібнішають під кінець; звільнений потік краде половину чужого залишку,
+//! тож нерівні за вартістю індекси теж розходяться рівно.
+//! Повертається, коли всі виклики завершилися.
+//! Одночасні виклики з різних потоків виконуються по черзі;
+//! викликати з самого fn (вкладено) не можна.
+//! -1 -- нульовий вказівник, 0 -- все ОК.
+int my_str_pool_run(my_str_pool_t *pool, size_t count, my_str_task_fn fn, void *arg) {
+	if (pool == NULL || fn == NULL) {
+		return -1;
+	}
+	if (count == 0) {
+		return 0;
+	}
+	pthread_mutex_lock(&pool->run_lock);
+	pthread_mutex_lock(&pool->lock);
+	pool->fn = fn;
+	pool->arg = arg;
+	pool->count = count;
+	for (size_t w = 0; w < pool->threads; w++) {
+		pool->slots[w].begin = count * w / pool->threads;
+		pool->slots[w].end = count * (w + 1) / pool->threads;
+	}
+	pool->pending = pool->threads - 1;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+
+	pool_work(pool, 0);
+
+	pthread_mutex_lock(&pool->lock);
+	while (pool->pending > 0) {
+		pthread_cond_wait(&pool->done, &pool->lock);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	pthread_mutex_unlock(&pool->run_lock);
+	return 0;
+}
+
+//! Кількість потоків пулу (номери worker -- від 0 до неї).
+size_t my_str_pool_threads(const my_str_pool_t *pool) {
+	return pool ? pool->threads : 0;
+}
+
+//! Зупинити потоки та звільнити пам'ять пулу. Якщо інший потік саме
+//! виконує my_str_pool_run(), спершу дочекатися його завершення; після
+//! повернення жоден потік пулу вже не працює. Повторний виклик нічого не робить.
+void my_str_pool_free(my_str_pool_t *pool) {
+	if (pool == NULL || pool->handles == NULL) {
+		return;
+	}
+	pthread_mutex_lock(&pool->run_lock);
+	pthread_mutex_unlock(&pool->run_lock);
+	pthread_mutex_lock(&pool->lock);
+	pool->stop = 1;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	for (size_t w = 1; w < pool->threads; w++) {
+		pthread_join(pool->handles[w - 1], NULL);
+	}
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->wake);
+	pthread_mutex_destroy(&pool->run_lock);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool->handles);
+	free(pool->slots);
+	pool->handles = NULL;
+	pool->slots = NULL;
+	pool->threads = 0;
+}
+
+//!===========================================================================
+//! Map-reduce по шматках тексту
+//!===========================================================================
+
+struct mapreduce_state {
+	my_str_view_t text;
+	const size_t *bounds;
+	const my_str_mapreduce_t *job;
+	char *accs;
+	size_t stride;
+	int failed;
+};
+
+static void mapreduce_task(size_t index, size_t worker, void *arg) {
+	struct mapreduce_state *st = arg;
+	size_t beg = st->bounds[index];
+	my_str_view_t chunk = my_str_view_sub(st->text, beg, st->bounds[index + 1]);
+	if (st->job->map(chunk, beg, st->accs + worker * st->stride, st->job->ctx) != 0) {
+		__atomic_store_n(&st->failed, 1, __ATOMIC_RELAXED);
+	}
+}
+
+static void mapreduce_acc_init(const my_str_mapreduce_t *job, void *acc) {
+	if (job->acc_init != NULL) {
+		job->acc_init(acc, job->ctx);
+	} else {
+		memset(acc, 0, job->acc_size);
+	}
+}
+
+//! Розбити text на шматки приблизно по job->chunk_size байт, кожен з яких
+//! закінчується на job->delimiter (або кінцем тексту), обробити їх job->map
+//! на потоках пулу, а потім злити акумулятори потоків у result через job->reduce.
+//! Злиття відбувається в порядку номерів потоків, у потоці, що викликав.
+//! pool == NULL -- тимчасовий пул на всі ядра; на одному ядрі чи для
+//! одного шматка шматки обробляються без потоків, у потоці, що викликав.
+//! result має бути розміром job->acc_size, його буде ініціалізовано.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять,
+//! -3 -- не вдалося створити потоки, -4 -- map або reduce повернули помилку.
+int my_str_mapreduce(my_str_pool_t *pool, my_str_view_t text, const my_str_mapreduce_t *job, void *result) {
+	if (job == NULL || job->map == NULL || job->reduce == NULL || result == NULL) {
+		return -1;
+	}
+	mapreduce_acc_init(job, result);
+	if (text.size_m == 0) {
+		return 0;
+	}
+
+	size_t chunk = job->chunk_size ? job->chunk_size : MY_STR_CHUNK_DEFAULT;
+	size_t cap = text.size_m / chunk + 2;
+	size_t *bounds = malloc(sizeof(size_t) * cap);
+	if (bounds == NULL) {
+		return -2;
+	}
+
+	// Межі шматків: кожна наступна -- одразу після першого
+	// роздільника, що не раніше за орієнтовну межу.
+	size_t n = 0;
+	bounds[0] = 0;
+	while (bounds[n] < text.size_m) {
+		size_t end = bounds[n] + chunk;
+		if (end >= text.size_m) {
+			end = text.size_m;
+		} else {
+			const char *p = memchr(text.data + end, job->delimiter, text.size_m - end);
+			end = p ? (size_t) (p - text.data) + 1 : text.size_m;
+		}
+		bounds[++n] = end;
+	}
+
+	my_str_pool_t own;
+	if (pool == NULL && n > 1 && my_str_cpu_count() > 1) {
+		if (my_str_pool_create(&own, 0) != 0) {
+			free(bounds);
+			return -3;
+		}
+		pool = &own;
+	}
+	size_t threads = pool ? my_str_pool_threads(pool) : 1;
+	size_t stride = (job->acc_size + MY_STR_CACHE_LINE - 1) / MY_STR_CACHE_LINE * MY_STR_CACHE_LINE;
+	void *accs = NULL;
+	if (stride == 0) {
+		stride = MY_STR_CACHE_LINE;
+	}
+	if (posix_memalign(&accs, MY_STR_CACHE_LINE, stride * threads) != 0) {
+		free(bounds);
+		if (pool == &own) {
+			my_str_pool_free(&own);
+		}
+		return -2;
+	}
+
+	for (size_t w = 0; w < threads; w++) {
+		mapreduce_acc_init(job, (char *) accs + w * stride);
+	}
+	struct mapreduce_state st = {text, bounds, job, accs, stride, 0};
+	if (pool != NULL) {
+		my_str_pool_run(pool, n, mapreduce_task, &st);
+	} else {
+		for (size_t i = 0; i < n; i++) {
+			mapreduce_task(i, 0, &st);
+		}
+	}
+
+	int rc = st.failed ? -4 : 0;
+	for (size_t w = 0; w < threads && rc == 0; w++) {
+		if (job->reduce(result, (char *) accs + w * stride, job->ctx) != 0) {
+			rc = -4;
+		}
+	}
+
+	free(accs);
+	free(bounds);
+	if (pool == &own) {
+		my_str_pool_free(&own);
+	}
+	return rc;
+}
+
+//! Те ж, що й my_str_mapreduce(), для всього файлу, відображеного в пам'ять.
+//! -5 -- не вдалося відкрити чи відобразити файл.
+int my_str_mapreduce_file(my_str_pool_t *pool, const char *path, const my_str_mapreduce_t *job, void *result) {
+	my_str_map_t map;
+	if (my_str_map_file(&map, path) != 0) {
+		return -5;
+	}
+	int rc = my_str_mapreduce(pool, my_str_map_view(&map), job, result);
+	my_str_unmap_file(&map);
+	return rc;
+}
+
+//!===========================================================================
+//! Пошук у великому тексті шматками з перекриттям
+//!===========================================================================
+
+#define MY_STR_SCAN_MIN (64u << 10)
+
+//! Шматок i відповідає за входження, що починаються в [i * chunk, (i + 1) * chunk),
+//! а переглядає ще tofind.size_m - 1 байт далі, щоб не загубити ті, що
+//! перетинають межу. Кожне входження належить рівно одному шматку.
+struct scan_state {
+	my_str_view_t text;
+	my_str_view_t tofind;
+	size_t chunk;
+	size_t first; // Найменша знайдена позиція (лише для пошуку першого)
+	size_t **hits; // По масиву позицій на шматок (лише для пошуку всіх)
+	size_t *nhits;
+	int failed;
+};
+
+static my_str_view_t scan_chunk(const struct scan_state *st, size_t index, size_t *beg, size_t *end) {
+	*beg = index * st->chunk;
+	*end = st->text.size_m - *beg > st->chunk ? *beg + st->chunk : st->text.size_m;
+	size_t stop = st->text.size_m - *end > st->tofind.size_m - 1 ? *end + st->tofind.size_m - 1 : st->text.size_m;
+	return my_str_view_sub(st->text, *beg, stop);
+}
+
+//! Розмір шматка: досить дрібно, щоб кожен потік отримав кілька
+//! (і пошук першого рано зупинявся), але не менше за tofind.
+static size_t scan_chunk_size(size_t threads, size_t size, size_t m) {
+	size_t chunk = size / (threads * 8);
+	if (chunk < MY_STR_SCAN_MIN) {
+		chunk = MY_STR_SCAN_MIN;
+	}
+	if (chunk > MY_STR_CHUNK_DEFAULT) {
+		chunk = MY_STR_CHUNK_DEFAULT;
+	}
+	return chunk < m ? m : chunk;
+}
+
+static void scan_first_task(size_t index, size_t worker, void *arg) {
+	(void) worker;
+	struct scan_state *st = arg;
+	size_t beg, end;
+	my_str_view_t view = scan_chunk(st, index, &beg, &end);
+	// Шматок після вже знайденого входження не цікавий.
+	if (beg >= __atomic_load_n(&st->first, __ATOMIC_RELAXED)) {
+		return;
+	}
+	size_t pos = my_str_view_find(view, st->tofind, 0);
+	if (pos == (size_t) -1 || beg + pos >= end) {
+		return;
+	}
+	pos += beg;
+	size_t cur = __atomic_load_n(&st->first, __ATOMIC_RELAXED);
+	while (pos < cur && !__atomic_compare_exchange_n(&st->first, &cur, pos, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+	}
+}
+
+static void scan_all_task(size_t index, size_t worker, void *arg) {
+	(void) worker;
+	struct scan_state *st = arg;
+	size_t beg, end;
+	my_str_view_t view = scan_chunk(st, index, &beg, &end);
+	size_t *hits = NULL;
+	size_t n = 0, cap = 0;
+	size_t pos = 0;
+	while ((pos = my_str_view_find(view, st->tofind, pos)) != (size_t) -1 && beg + pos < end) {
+		if (n == cap) {
+			cap = cap ? cap * 2 : 16;
+			size_t *grown = realloc(hits, sizeof(size_t) * cap);
+			if (grown == NULL) {
+				__atomic_store_n(&st->failed, 1, __ATOMIC_RELAXED);
+				break;
+			}
+			hits = grown;
+		}
+		hits[n++] = beg + pos++;
+	}
+	st->hits[index] = hits;
+	st->nhits[index] = n;
+}
+
+//! Паралельний аналог my_str_view_find(): перше входження tofind у text,
+//! не раніше за from, або (size_t)(-1). На відміну від my_str_par_find(),
+//! текст ділиться не по записах, а на рівні шматки з перекриттям у
+//! tofind.size_m - 1 байт, тож знаходиться будь-яке входження.
+//! Результат не залежить від кількості потоків.
+//! pool == NULL -- тимчасовий пул на всі ядра; на одному ядрі --
+//! звичайний my_str_view_find() без потоків.
+size_t my_str_par_find_first(my_str_pool_t *pool, my_str_view_t text, my_str_view_t tofind, size_t from) {
+	if (from > text.size_m || text.size_m - from < tofind.size_m) {
+		return (size_t) -1;
+	}
+	if (tofind.size_m == 0 || text.size_m - from <= MY_STR_SCAN_MIN) {
+		return my_str_view_find(text, tofind, from);
+	}
+	my_str_view_t rest = my_str_view_sub(text, from, text.size_m);
+	size_t threads = pool ? my_str_pool_threads(pool) : my_str_cpu_count();
+	struct scan_state st = {rest, tofind, scan_chunk_size(threads, rest.size_m, tofind.size_m), (size_t) -1, NULL, NULL, 0};
+	size_t n = (rest.size_m + st.chunk - 1) / st.chunk;
+	my_str_pool_t own;
+	if (pool == NULL) {
+		if (threads == 1 || n == 1 || my_str_pool_create(&own, 0) != 0) {
+			return my_str_view_find(text, tofind, from);
+		}
+		pool = &own;
+	}
+	my_str_pool_run(pool, n, scan_first_task, &st);
+
+	if (pool == &own) {
+		my_str_pool_free(&own);
+	}
+	return st.first == (size_t) -1 ? st.first : from + st.first;
+}
+
+//! Усі входження tofind у text (зокрема ті, що перекриваються) у порядку
+//! зростання -- у *positions (звільнити через free()) і *count.
+//! Потоки збирають позиції своїх шматків окремо, а склеюються вони в
+//! порядку шматків, тож результат не залежить від розкладу потоків.
+//! Порожня tofind не має входжень.
+//! pool == NULL -- тимчасовий пул на всі ядра; на одному ядрі чи для
+//! одного шматка весь текст переглядається без потоків.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять,
+//! -3 -- не вдалося створити потоки.
+int my_str_par_find_all(my_str_pool_t *pool, my_str_view_t text, my_str_view_t tofind, size_t **positions, size_t *count) {
+	if (positions == NULL || count == NULL) {
+		return -1;
+	}
+	*positions = NULL;
+	*count = 0;
+	if (tofind.size_m == 0 || text.size_m < tofind.size_m) {
+		return 0;
+	}
+	size_t threads = pool ? my_str_pool_threads(pool) : my_str_cpu_count();
+	struct scan_state st = {text, tofind, scan_chunk_size(threads, text.size_m, tofind.size_m), 0, NULL, NULL, 0};
+	size_t n = (text.size_m + st.chunk - 1) / st.chunk;
+	my_str_pool_t own;
+	if (pool == NULL && threads > 1 && n > 1) {
+		if (my_str_pool_create(&own, 0) != 0) {
+			return -3;
+		}
+		pool = &own;
+	} else if (pool == NULL) {
+		st.chunk = text.size_m;
+		n = 1;
+	}
+	st.hits = calloc(n, sizeof(size_t *));
+	st.nhits = calloc(n, sizeof(size_t));
+	int rc = 0;
+	if (st.hits == NULL || st.nhits == NULL) {
+		rc = -2;
+	} else if (n == 1) {
+		scan_all_task(0, 0, &st);
+	} else {
+		my_str_pool_run(pool, n, scan_all_task, &st);
+	}
+	if (pool == &own) {
+		my_str_pool_free(&own);
+	}
+
+	size_t total = 0;
+	for (size_t i = 0; rc == 0 && i < n; i++) {
+		total += st.nhits[i];
+	}
+	if (rc == 0 && st.failed) {
+		rc = -2;
+	}
+	if (rc == 0 && total != 0) {
+		if ((*positions = malloc(sizeof(size_t) * total)) == NULL) {
+			rc = -2;
+		} else {
+			for (size_t i = 0; i < n; i++) {
+				if (st.nhits[i] != 0) {
+					memcpy(*positions + *count, st.hits[i], sizeof(size_t) * st.nhits[i]);
+					*count += st.nhits[i];
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; st.hits != NULL && i < n; i++) {
+		free(st.hits[i]);
+	}
+	free(st.hits);
+	free(st.nhits);
+	return rc;
+}
+
+//! my_str_find() на потоках пулу -- див. my_str_par_find_first().
+size_t my_str_par_find_str(my_str_pool_t *pool, const my_str_t *str, const my_str_t *tofind, size_t from) {
+	if (str == NULL || tofind == NULL) {
+		return (size_t) -1;
+	}
+	return my_str_par_find_first(pool, my_str_view(str), my_str_view(tofind), from);
+}
+
+//! my_str_find_c() на потоках пулу -- див. my_str_par_find_first().
+size_t my_str_par_find_c(my_str_pool_t *pool, const my_str_t *str, char tofind, size_t from) {
+	if (str == NULL) {
+		return (size_t) -1;
+	}
+	my_str_view_t c = {&tofind, 1};
+	return my_str_par_find_first(pool, my_str_view(str), c, from);
+}
+
+//!===========================================================================
+//! Приклади використання: пошук, підрахунок, статистика слів
+//!===========================================================================
+
+static void find_init(void *acc, void *ctx) {
+	(void) ctx;
+	*(size_t *) acc = (size_t) -1;
+}
+
+static int find_map(my_str_view_t chunk, size_t offset, void *acc, void *ctx) {
+	const my_str_view_t *tofind = ctx;
+	// Шматок після вже знайденого входження не цікавий.
+	if (offset >= *(size_t *) acc) {
+		return 0;
+	}
+	const char *p = memmem(chunk.data, chunk.size_m, tofind->data, tofind->size_m);
+	if (p != NULL) {
+		*(size_t *) acc = offset + (size_t) (p - chunk.data);
+	}
+	return 0;
+}
+
+static int find_reduce(void *into, const void *from, void *ctx) {
+	(void) ctx;
+	if (*(const size_t *) from < *(size_t *) into) {
+		*(size_t *) into = *(const size_t *) from;
+	}
+	return 0;
+}
+
+//! Паралельний аналог my_str_find(): перше входження tofind у text
+//! або (size_t)(-1), якщо не знайдено.
+//! Текст ділиться по delimiter, тож tofind не повинна його містити --
+//! входження, що перетинають межу запису, не знаходяться
+//! (для довільного тексту -- my_str_par_find_first()).
+size_t my_str_par_find(my_str_pool_t *pool, my_str_view_t text, my_str_view_t tofind, char delimiter) {
+	if (tofind.size_m == 0) {
+		return 0;
+	}
+	my_str_mapreduce_t job = {0, delimiter, sizeof(size_t), find_init, find_map, find_reduce, &tofind};
+	size_t pos;
+	if (my_str_mapreduce(pool, text, &job, &pos) != 0) {
+		return (size_t) -1;
+	}
+	return pos;
+}
+
+static int count_map(my_str_view_t chunk, size_t offset, void *acc, void *ctx) {
+	(void) offset;
+	const my_str_view_t *tofind = ctx;
+	const char *p = chunk.data;
+	const char *end = chunk.data + chunk.size_m;
+	while ((p = memmem(p, (size_t) (end - p), tofind->data, tofind->size_m)) != NULL) {
+		++*(size_t *) acc;
+		p += tofind->size_m;
+	}
+	return 0;
+}
+
+static int count_reduce(void *into, const void *from, void *ctx) {
+	(void) ctx;
+	*(size_t *) into += *(const size_t *) from;
+	return 0;
+}
+
+//! Кількість входжень tofind у text, що не перекриваються.
+//! Обмеження щодо delimiter -- як у my_str_par_find().
+size_t my_str_par_count(my_str_pool_t *pool, my_str_view_t text, my_str_view_t tofind, char delimiter) {
+	if (tofind.size_m == 0) {
+		return 0;
+	}
+	my_str_mapreduce_t job = {0, delimiter, sizeof(size_t), NULL, count_map, count_reduce, &tofind};
+	size_t count;
+	if (my_str_mapreduce(pool, text, &job, &count) != 0) {
+		return 0;
+	}
+	return count;
+}
+
+static void wordstat_init(void *acc, void *ctx) {
+	(void) ctx;
+	my_str_wordstat_init(acc);
+}
+
+static int wordstat_map(my_str_view_t chunk, size_t offset, void *acc, void *ctx) {
+	(void) offset;
+	(void) ctx;
+	my_str_wordstat_t *stat = acc;
+	// Шматки одного потоку не сусідні -- речення між ними не продовжується,
+	// а слово не продовжується за кінець рядка.
+	stat->after_word = 0;
+	my_str_wordstat_feed(stat, chunk);
+	my_str_wordstat_finish(stat);
+	return 0;
+}
+
+static int wordstat_reduce(void *into, const void *from, void *ctx) {
+	(void) ctx;
+	my_str_wordstat_merge(into, from);
+	return 0;
+}
+
+//! Паралельно порахувати статистику слів тексту (див. str_wordstat.h).
+//! Текст ділиться по рядках, тож слово не може розірватися між шматками.
+//! Повертає коди помилок my_str_mapreduce().
+int my_str_par_wordstat(my_str_pool_t *pool, my_str_view_t text, my_str_wordstat_t *stat) {
+	my_str_mapreduce_t job = {0, '\n', sizeof(my_str_wordstat_t), wordstat_init, wordstat_map, wordstat_reduce, NULL};
+	return my_str_mapreduce(pool, text, &job, stat);
+}
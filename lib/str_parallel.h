@@ -0,0 +1,72 @@
+#ifndef STRLIB_PARALLEL_H
+#define STRLIB_PARALLEL_H
+#include <stdio.h>
+#include <pthread.h>
+#include "stringg.h"
+#include "str_view.h"
+#include "str_wordstat.h"
+
+//! Завдання для пулу: index -- номер елемента, worker -- номер потоку [0, threads).
+typedef void (*my_str_task_fn)(size_t index, size_t worker, void* arg);
+
+//! Смуга індексів одного потоку [begin, end); власник бере спереду,
+//! інші крадуть ззаду. Кожна -- на своїй кеш-лінії.
+typedef struct
+{
+	size_t begin;
+	size_t end;
+	int lock;
+	char pad[64 - 2 * sizeof(size_t) - sizeof(int)];
+} my_str_pool_slot_t;
+
+typedef struct
+{
+	size_t threads;		 // Кількість потоків, разом із тим, що викликає run
+	pthread_t* handles;	 // Фонові потоки (threads - 1 штук)
+	pthread_mutex_t lock;
+	pthread_mutex_t run_lock;
+	pthread_cond_t wake;
+	pthread_cond_t done;
+	size_t generation;	 // Номер поточного завдання
+	size_t pending;		 // Скільки фонових потоків ще працюють
+	my_str_pool_slot_t* slots; // По смузі індексів на потік
+	size_t count;
+	my_str_task_fn fn;
+	void* arg;
+	int stop;
+} my_str_pool_t;
+
+int my_str_pool_create(my_str_pool_t* pool, size_t threads);
+int my_str_pool_run(my_str_pool_t* pool, size_t count, my_str_task_fn fn, void* arg);
+size_t my_str_pool_threads(const my_str_pool_t* pool);
+void my_str_pool_free(my_str_pool_t* pool);
+size_t my_str_cpu_count(void);
+
+//! map -- обробити один шматок (offset -- його зсув від початку тексту),
+//! накопичуючи результат у acc свого потоку.
+//! reduce -- злити акумулятор from в into.
+typedef int (*my_str_map_fn)(my_str_view_t chunk, size_t offset, void* acc, void* ctx);
+typedef int (*my_str_reduce_fn)(void* into, const void* from, void* ctx);
+
+typedef struct
+{
+	size_t chunk_size;				   // Орієнтовний розмір шматка, 0 -- за замовчуванням
+	char delimiter;					   // Шматки закінчуються на межі запису
+	size_t acc_size;				   // Розмір акумулятора в байтах
+	void (*acc_init)(void* acc, void* ctx); // NULL -- заповнити нулями
+	my_str_map_fn map;
+	my_str_reduce_fn reduce;
+	void* ctx;
+} my_str_mapreduce_t;
+
+int my_str_mapreduce(my_str_pool_t* pool, my_str_view_t text, const my_str_mapreduce_t* job, void* result);
+int my_str_mapreduce_file(my_str_pool_t* pool, const char* path, const my_str_mapreduce_t* job, void* result);
+
+size_t my_str_par_find(my_str_pool_t* pool, my_str_view_t text, my_str_view_t tofind, char delimiter);
+size_t my_str_par_count(my_str_pool_t* pool, my_str_view_t text, my_str_view_t tofind, char delimiter);
+size_t my_str_par_find_first(my_str_pool_t* pool, my_str_view_t text, my_str_view_t tofind, size_t from);
+int my_str_par_find_all(my_str_pool_t* pool, my_str_view_t text, my_str_view_t tofind, size_t** positions, size_t* count);
+size_t my_str_par_find_str(my_str_pool_t* pool, const my_str_t* str, const my_str_t* tofind, size_t from);
+size_t my_str_par_find_c(my_str_pool_t* pool, const my_str_t* str, char tofind, size_t from);
+int my_str_par_wordstat(my_str_pool_t* pool, my_str_view_t text, my_str_wordstat_t* stat);
+#endif //STRLIB_PARALLEL_H
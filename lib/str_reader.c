@@ -0,0 +1,131 @@
+//
+// Інкрементний читач записів для циклів подій (epoll та ін.).
+//
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include "str_reader.h"
+
+#define MY_STR_READER_MIN_READ 4096
+
+//! Створити читач із буфером buf_size (0 -- за замовчуванням).
+//! Після використання -- викличте my_str_reader_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_reader_create(my_str_reader_t *reader, char delimiter, size_t buf_size) {
+	if (reader == NULL) {
+		return -1;
+	}
+	my_str_create(&reader->buf, buf_size ? buf_size : 2 * MY_STR_READER_MIN_READ);
+	if (reader->buf.data == NULL) {
+		return -2;
+	}
+	reader->start = 0;
+	reader->scanned = 0;
+	reader->delimiter = delimiter;
+	reader->eof = 0;
+	return 0;
+}
+
+//! Звільнити буфер читача.
+void my_str_reader_free(my_str_reader_t *reader) {
+	if (reader != NULL) {
+		my_str_free(&reader->buf);
+	}
+}
+
+//! Забезпечити місце ще для want байт у кінці буфера.
+//! Спершу зсуває невіддані байти на початок -- вже віддані записи
+//! більше не потрібні; якщо й так мало -- збільшує буфер удвічі.
+static int reader_make_room(my_str_reader_t *reader, size_t want) {
+	my_str_t *buf = &reader->buf;
+	if (buf->capacity_m - buf->size_m >= want) {
+		return 0;
+	}
+	if (reader->start > 0) {
+		size_t rest = buf->size_m - reader->start;
+		memmove(buf->data, buf->data + reader->start, rest);
+		buf->size_m = rest;
+		reader->scanned -= reader->start;
+		reader->start = 0;
+		if (buf->capacity_m - buf->size_m >= want) {
+			return 0;
+		}
+	}
+	size_t cap = buf->capacity_m * 2;
+	if (cap < buf->size_m + want) {
+		cap = buf->size_m + want;
+	}
+	my_str_reserve(buf, cap);
+	return buf->data != NULL && buf->capacity_m >= cap ? 0 : -2;
+}
+
+//! Додати len байт, що надійшли. Самі записи віддає my_str_reader_next().
+//! Усі раніше видані погляди стають некоректними.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_reader_feed(my_str_reader_t *reader, const char *data, size_t len) {
+	if (reader == NULL || (data == NULL && len > 0)) {
+		return -1;
+	}
+	if (reader_make_room(reader, len) != 0) {
+		return -2;
+	}
+	memcpy(reader->buf.data + reader->buf.size_m, data, len);
+	reader->buf.size_m += len;
+	return 0;
+}
+
+//! Прочитати з fd все, що є зараз, одним read(), без очікування.
+//! Усі раніше видані погляди стають некоректними.
+//! Повертає 1 -- прочитано хоч щось, 0 -- кінець файлу (тепер
+//! my_str_reader_next() віддасть і останній запис без роздільника),
+//! -1 -- даних поки немає (EAGAIN), -2 -- не вдалося виділити пам'ять,
+//! -3 -- помилка читання.
+int my_str_reader_fill(my_str_reader_t *reader, int fd) {
+	if (reader == NULL) {
+		return -3;
+	}
+	if (reader_make_room(reader, MY_STR_READER_MIN_READ) != 0) {
+		return -2;
+	}
+	my_str_t *buf = &reader->buf;
+	ssize_t n;
+	do {
+		n = read(fd, buf->data + buf->size_m, buf->capacity_m - buf->size_m);
+	} while (n < 0 && errno == EINTR);
+	if (n < 0) {
+		return errno == EAGAIN || errno == EWOULDBLOCK ? -1 : -3;
+	}
+	if (n == 0) {
+		reader->eof = 1;
+		return 0;
+	}
+	buf->size_m += (size_t) n;
+	return 1;
+}
+
+//! Віддати наступний повний запис (без роздільника) як погляд у буфер читача.
+//! Погляд коректний до наступного my_str_reader_feed()/my_str_reader_fill().
+//! Кожен байт перевіряється на роздільник лише раз, хоч би скільки
+//! порцій знадобилося, щоб запис надійшов повністю.
+//! Повертає 1 -- запис є, 0 -- потрібно більше даних, -1 -- нульовий вказівник.
+int my_str_reader_next(my_str_reader_t *reader, my_str_view_t *record) {
+	if (reader == NULL || record == NULL) {
+		return -1;
+	}
+	my_str_t *buf = &reader->buf;
+	const char *p = memchr(buf->data + reader->scanned, reader->delimiter, buf->size_m - reader->scanned);
+	if (p == NULL) {
+		reader->scanned = buf->size_m;
+		if (!reader->eof || reader->start == buf->size_m) {
+			return 0;
+		}
+		// Після кінця файлу -- залишок без роздільника теж запис.
+		p = buf->data + buf->size_m;
+	}
+	size_t end = (size_t) (p - buf->data);
+	record->data = buf->data + reader->start;
+	record->size_m = end - reader->start;
+	reader->start = end < buf->size_m ? end + 1 : end;
+	reader->scanned = reader->start;
+	return 1;
+}
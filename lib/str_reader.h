@@ -0,0 +1,23 @@
+#ifndef STRLIB_READER_H
+#define STRLIB_READER_H
+#include <stdio.h>
+#include "stringg.h"
+#include "str_view.h"
+
+//! Інкрементний розбір записів для неблокуючих дескрипторів.
+//! Байти подаються порціями, які є; неповний запис чекає в buf.
+typedef struct
+{
+	my_str_t buf;	// Прочитані, ще не віддані байти
+	size_t start;	// Початок першого не відданого запису в buf
+	size_t scanned; // До цієї позиції buf роздільника вже немає
+	char delimiter;
+	int eof;		// Джерело вичерпано
+} my_str_reader_t;
+
+int my_str_reader_create(my_str_reader_t* reader, char delimiter, size_t buf_size);
+void my_str_reader_free(my_str_reader_t* reader);
+int my_str_reader_feed(my_str_reader_t* reader, const char* data, size_t len);
+int my_str_reader_fill(my_str_reader_t* reader, int fd);
+int my_str_reader_next(my_str_reader_t* reader, my_str_view_t* record);
+#endif //STRLIB_READER_H
@@ -0,0 +1,543 @@
+//
+// Суфіксний масив (SA-IS) та FM-індекс для повторних запитів до одного тексту.
+//
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "str_sa.h"
+#include "str_file.h"
+
+#define EMPTY UINT32_MAX
+
+//!===========================================================================
+//! SA-IS (Nong, Zhang, Chan), лінійний час
+//!===========================================================================
+
+//! Рівень 0 -- байти тексту з уявним роздільником у кінці (символ 0, решта +1);
+//! глибші рівні -- масиви uint32_t імен, роздільник у них уже є.
+typedef struct {
+	const unsigned char *bytes;
+	const uint32_t *ints;
+} sais_text_t;
+
+static uint32_t chr(const sais_text_t *s, size_t n, size_t i) {
+	if (s->ints != NULL) {
+		return s->ints[i];
+	}
+	return i + 1 == n ? 0 : (uint32_t) s->bytes[i] + 1;
+}
+
+#define TGET(t, i) (((t)[(i) >> 3] >> ((i) & 7)) & 1)
+#define TSET(t, i, b) ((t)[(i) >> 3] = (unsigned char) ((b) ? (t)[(i) >> 3] | (1u << ((i) & 7)) : (t)[(i) >> 3] & ~(1u << ((i) & 7))))
+#define IS_LMS(t, i) ((i) > 0 && (i) != EMPTY && TGET(t, i) && !TGET(t, (i) - 1))
+
+static void get_buckets(const sais_text_t *s, uint32_t *bkt, size_t n, size_t k, int end) {
+	memset(bkt, 0, sizeof(uint32_t) * (k + 1));
+	for (size_t i = 0; i < n; i++) {
+		bkt[chr(s, n, i)]++;
+	}
+	uint32_t sum = 0;
+	for (size_t i = 0; i <= k; i++) {
+		sum += bkt[i];
+		bkt[i] = end ? sum : sum - bkt[i];
+	}
+}
+
+static void induce(const unsigned char *t, uint32_t *sa, const sais_text_t *s, uint32_t *bkt, size_t n, size_t k) {
+	get_buckets(s, bkt, n, k, 0);
+	for (size_t i = 0; i < n; i++) {
+		if (sa[i] != EMPTY && sa[i] > 0 && !TGET(t, sa[i] - 1)) {
+			uint32_t j = sa[i] - 1;
+			sa[bkt[chr(s, n, j)]++] = j;
+		}
+	}
+	get_buckets(s, bkt, n, k, 1);
+	for (size_t i = n; i-- > 0;) {
+		if (sa[i] != EMPTY && sa[i] > 0 && TGET(t, sa[i] - 1)) {
+			uint32_t j = sa[i] - 1;
+			sa[--bkt[chr(s, n, j)]] = j;
+		}
+	}
+}
+
+//! Суфіксний масив s довжини n (останній символ -- унікальний найменший) в sa.
+//! k -- найбільший символ. -2 -- не вдалося виділити пам'ять.
+static int sais(const sais_text_t *s, uint32_t *sa, size_t n, size_t k) {
+	if (n == 1) {
+		sa[0] = 0;
+		return 0;
+	}
+	unsigned char *t = calloc(n / 8 + 1, 1);
+	uint32_t *bkt = malloc(sizeof(uint32_t) * (k + 1));
+	if (t == NULL || bkt == NULL) {
+		free(t);
+		free(bkt);
+		return -2;
+	}
+	// Типи суфіксів: S (1) чи L (0).
+	TSET(t, n - 1, 1);
+	if (n >= 2) {
+		TSET(t, n - 2, 0);
+	}
+	for (size_t i = n >= 2 ? n - 2 : 0; i-- > 0;) {
+		uint32_t a = chr(s, n, i);
+		uint32_t b = chr(s, n, i + 1);
+		TSET(t, i, a < b || (a == b && TGET(t, i + 1)));
+	}
+
+	// Етап 1: відсортувати LMS-підстрічки.
+	get_buckets(s, bkt, n, k, 1);
+	for (size_t i = 0; i < n; i++) {
+		sa[i] = EMPTY;
+	}
+	for (size_t i = 1; i < n; i++) {
+		if (IS_LMS(t, i)) {
+			sa[--bkt[chr(s, n, i)]] = (uint32_t) i;
+		}
+	}
+	induce(t, sa, s, bkt, n, k);
+
+	size_t n1 = 0;
+	for (size_t i = 0; i < n; i++) {
+		if (IS_LMS(t, sa[i])) {
+			sa[n1++] = sa[i];
+		}
+	}
+	for (size_t i = n1; i < n; i++) {
+		sa[i] = EMPTY;
+	}
+	// Дати LMS-підстрічкам імена; однакові -- однакові імена.
+	uint32_t name = 0;
+	uint32_t prev = EMPTY;
+	for (size_t i = 0; i < n1; i++) {
+		uint32_t pos = sa[i];
+		int diff = 0;
+		for (size_t d = 0; d < n; d++) {
+			if (prev == EMPTY || chr(s, n, pos + d) != chr(s, n, prev + d) || TGET(t, pos + d) != TGET(t, prev + d)) {
+				diff = 1;
+				break;
+			}
+			if (d > 0 && (IS_LMS(t, pos + d) || IS_LMS(t, prev + d))) {
+				break;
+			}
+		}
+		if (diff) {
+			name++;
+			prev = pos;
+		}
+		sa[n1 + pos / 2] = name - 1;
+	}
+	for (size_t i = n, j = n; i-- > n1;) {
+		if (sa[i] != EMPTY) {
+			sa[--j] = sa[i];
+		}
+	}
+
+	// Етап 2: суфіксний масив скороченого рядка -- рекурсивно, якщо імена повторюються.
+	uint32_t *sa1 = sa;
+	uint32_t *s1 = sa + n - n1;
+	if (name < n1) {
+		sais_text_t sub = {NULL, s1};
+		if (sais(&sub, sa1, n1, name - 1) != 0) {
+			free(t);
+			free(bkt);
+			return -2;
+		}
+	} else {
+		for (size_t i = 0; i < n1; i++) {
+			sa1[s1[i]] = (uint32_t) i;
+		}
+	}
+
+	// Етап 3: розставити LMS-суфікси за порядком і індукувати решту.
+	get_buckets(s, bkt, n, k, 1);
+	for (size_t i = 1, j = 0; i < n; i++) {
+		if (IS_LMS(t, i)) {
+			s1[j++] = (uint32_t) i;
+		}
+	}
+	for (size_t i = 0; i < n1; i++) {
+		sa1[i] = s1[sa1[i]];
+	}
+	for (size_t i = n1; i < n; i++) {
+		sa[i] = EMPTY;
+	}
+	for (size_t i = n1; i-- > 0;) {
+		uint32_t j = sa[i];
+		sa[i] = EMPTY;
+		sa[--bkt[chr(s, n, j)]] = j;
+	}
+	induce(t, sa, s, bkt, n, k);
+	free(bkt);
+	free(t);
+	return 0;
+}
+
+//!===========================================================================
+//! Суфіксний масив
+//!===========================================================================
+
+//! Побудувати суфіксний масив тексту за лінійний час (SA-IS).
+//! Після використання -- викличте my_str_sa_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять,
+//! -3 -- текст довший за 4 ГіБ, 0 -- все ОК.
+int my_str_sa_create(my_str_sa_t *sa, my_str_view_t text) {
+	if (sa == NULL || (text.data == NULL && text.size_m > 0)) {
+		return -1;
+	}
+	if (text.size_m >= EMPTY - 1) {
+		return -3;
+	}
+	sa->text = text;
+	sa->size_m = text.size_m;
+	sa->sa = malloc(sizeof(uint32_t) * (text.size_m + 1));
+	if (sa->sa == NULL) {
+		return -2;
+	}
+	sais_text_t s = {(const unsigned char *) text.data, NULL};
+	if (sais(&s, sa->sa, text.size_m + 1, 256) != 0) {
+		my_str_sa_free(sa);
+		return -2;
+	}
+	// Перший -- суфікс-роздільник, він не потрібен.
+	memmove(sa->sa, sa->sa + 1, sizeof(uint32_t) * text.size_m);
+	return 0;
+}
+
+void my_str_sa_free(my_str_sa_t *sa) {
+	if (sa != NULL) {
+		free(sa->sa);
+		sa->sa = NULL;
+		sa->size_m = 0;
+	}
+}
+
+//! Порівняти суфікс pos із pattern лише на довжину pattern.
+static int suffix_cmp(const my_str_sa_t *sa, uint32_t pos, my_str_view_t pattern) {
+	size_t len = sa->size_m - pos;
+	int r = memcmp(sa->text.data + pos, pattern.data, len < pattern.size_m ? len : pattern.size_m);
+	if (r == 0 && len < pattern.size_m) {
+		return -1;
+	}
+	return r;
+}
+
+//! Межі [lo, hi) суфіксів, що починаються з pattern -- двійковим пошуком.
+static void sa_range(const my_str_sa_t *sa, my_str_view_t pattern, size_t *from, size_t *to) {
+	size_t lo = 0;
+	size_t hi = sa->size_m;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (suffix_cmp(sa, sa->sa[mid], pattern) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	*from = lo;
+	hi = sa->size_m;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (suffix_cmp(sa, sa->sa[mid], pattern) <= 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	*to = lo;
+}
+
+//! Кількість входжень pattern, O(m log n). Для O(m) -- my_str_fm_count().
+size_t my_str_sa_count(const my_str_sa_t *sa, my_str_view_t pattern) {
+	size_t from;
+	size_t to;
+	if (sa == NULL || pattern.size_m == 0) {
+		return 0;
+	}
+	sa_range(sa, pattern, &from, &to);
+	return to - from;
+}
+
+//! Усі входження pattern: *positions -- на ділянку суфіксного масиву
+//! (позиції не за зростанням, а в порядку суфіксів). Повертає їх кількість.
+size_t my_str_sa_locate(const my_str_sa_t *sa, my_str_view_t pattern, const uint32_t **positions) {
+	size_t from;
+	size_t to;
+	if (sa == NULL || positions == NULL || pattern.size_m == 0) {
+		return 0;
+	}
+	sa_range(sa, pattern, &from, &to);
+	*positions = sa->sa + from;
+	return to - from;
+}
+
+//!===========================================================================
+//! FM-індекс
+//!===========================================================================
+
+#define FM_MAGIC "MYSTRFM1"
+#define OCC_STEP 512
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t sample;
+	uint64_t size;
+	uint64_t primary;
+	uint64_t nsamples;
+	uint64_t block_len;
+	uint64_t C[257];
+} fm_header_t;
+
+static size_t align8(size_t n) {
+	return (n + 7) & ~(size_t) 7;
+}
+
+//! Розкласти вказівники fm по блоку (однаково для побудови й завантаження).
+static void fm_layout(my_str_fm_t *fm, size_t *len) {
+	const fm_header_t *hdr = fm->block;
+	char *p = fm->block;
+	size_t rows = (size_t) hdr->size + 1;
+	size_t words = rows / 64 + 1;
+	size_t off = sizeof(fm_header_t);
+	fm->size_m = (size_t) hdr->size;
+	fm->rows = rows;
+	fm->primary = (size_t) hdr->primary;
+	fm->C = hdr->C;
+	fm->bwt = (const uint8_t *) (p + off);
+	off = align8(off + rows);
+	fm->occ = (const uint32_t *) (p + off);
+	off = align8(off + sizeof(uint32_t) * 256 * (rows / OCC_STEP + 1));
+	fm->marks = (const uint64_t *) (p + off);
+	off += sizeof(uint64_t) * words;
+	fm->mark_rank = (const uint32_t *) (p + off);
+	off = align8(off + sizeof(uint32_t) * words);
+	fm->samples = (const uint32_t *) (p + off);
+	off += sizeof(uint32_t) * (size_t) hdr->nsamples;
+	if (len != NULL) {
+		*len = off;
+	}
+}
+
+//! Кількість символів c у bwt[0, i).
+static size_t occ(const my_str_fm_t *fm, unsigned char c, size_t i) {
+	size_t base = i / OCC_STEP * OCC_STEP;
+	size_t count = fm->occ[i / OCC_STEP * 256 + c];
+	for (size_t k = base; k < i; k++) {
+		count += fm->bwt[k] == c;
+	}
+	// Рядок роздільника теж має байт 0 у bwt, але символом не є.
+	if (c == 0 && fm->primary >= base && fm->primary < i) {
+		count--;
+	}
+	return count;
+}
+
+static int marked(const my_str_fm_t *fm, size_t row) {
+	return (int) (fm->marks[row / 64] >> (row % 64) & 1);
+}
+
+static size_t mark_rank(const my_str_fm_t *fm, size_t row) {
+	uint64_t below = fm->marks[row / 64] & ((1ull << (row % 64)) - 1);
+	return fm->mark_rank[row / 64] + (size_t) __builtin_popcountll(below);
+}
+
+//! Побудувати FM-індекс за суфіксним масивом (і його текстом).
+//! Після використання -- викличте my_str_fm_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_fm_create(my_str_fm_t *fm, const my_str_sa_t *sa) {
+	if (fm == NULL || sa == NULL) {
+		return -1;
+	}
+	memset(fm, 0, sizeof(*fm));
+	size_t n = sa->size_m;
+	size_t rows = n + 1;
+	const unsigned char *text = (const unsigned char *) sa->text.data;
+	// Рядок 0 -- суфікс-роздільник (позиція n), рядок i > 0 -- sa[i - 1].
+#define ROW_POS(i) ((i) == 0 ? (uint32_t) n : sa->sa[(i) - 1])
+	size_t nsamples = 0;
+	for (size_t i = 0; i < rows; i++) {
+		nsamples += ROW_POS(i) % MY_STR_FM_SAMPLE == 0;
+	}
+	fm_header_t hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, FM_MAGIC, 8);
+	hdr.version = 1;
+	hdr.sample = MY_STR_FM_SAMPLE;
+	hdr.size = n;
+	hdr.nsamples = nsamples;
+
+	fm->block = &hdr;
+	size_t len;
+	fm_layout(fm, &len);
+	fm->block = calloc(1, len);
+	if (fm->block == NULL) {
+		return -2;
+	}
+	fm->block_len = len;
+	fm_header_t *h = fm->block;
+	*h = hdr;
+	h->block_len = len;
+	fm_layout(fm, NULL);
+
+	uint8_t *bwt = (uint8_t *) fm->bwt;
+	uint32_t *occ_tab = (uint32_t *) fm->occ;
+	uint64_t *marks = (uint64_t *) fm->marks;
+	uint32_t *ranks = (uint32_t *) fm->mark_rank;
+	uint32_t *samples = (uint32_t *) fm->samples;
+	uint32_t counts[256] = {0};
+	size_t s = 0;
+	for (size_t i = 0; i < rows; i++) {
+		if (i % OCC_STEP == 0) {
+			memcpy(occ_tab + i / OCC_STEP * 256, counts, sizeof(counts));
+		}
+		if (i % 64 == 0) {
+			ranks[i / 64] = (uint32_t) s;
+		}
+		uint32_t pos = ROW_POS(i);
+		if (pos == 0) {
+			h->primary = i;
+			bwt[i] = 0;
+		} else {
+			bwt[i] = text[pos - 1];
+			counts[bwt[i]]++;
+		}
+		if (pos % MY_STR_FM_SAMPLE == 0) {
+			marks[i / 64] |= 1ull << (i % 64);
+			samples[s++] = pos;
+		}
+	}
+	if (rows % OCC_STEP == 0) {
+		memcpy(occ_tab + rows / OCC_STEP * 256, counts, sizeof(counts));
+	}
+	if (rows % 64 == 0) {
+		ranks[rows / 64] = (uint32_t) s;
+	}
+#undef ROW_POS
+	h->C[0] = 1;
+	for (size_t c = 0; c < 256; c++) {
+		h->C[c + 1] = h->C[c] + counts[c];
+	}
+	fm_layout(fm, NULL);
+	return 0;
+}
+
+void my_str_fm_free(my_str_fm_t *fm) {
+	if (fm == NULL || fm->block == NULL) {
+		return;
+	}
+	if (fm->mapped) {
+		munmap(fm->block, fm->block_len);
+	} else {
+		free(fm->block);
+	}
+	memset(fm, 0, sizeof(*fm));
+}
+
+//! Зворотний пошук: межі [*sp, *ep) рядків, що починаються з pattern. O(m).
+static size_t fm_range(const my_str_fm_t *fm, my_str_view_t pattern, size_t *sp, size_t *ep) {
+	*sp = 0;
+	*ep = fm->rows;
+	for (size_t i = pattern.size_m; i-- > 0 && *sp < *ep;) {
+		unsigned char c = (unsigned char) pattern.data[i];
+		*sp = (size_t) fm->C[c] + occ(fm, c, *sp);
+		*ep = (size_t) fm->C[c] + occ(fm, c, *ep);
+	}
+	return *sp < *ep ? *ep - *sp : 0;
+}
+
+//! Кількість входжень pattern, O(m) -- не залежить від довжини тексту.
+size_t my_str_fm_count(const my_str_fm_t *fm, my_str_view_t pattern) {
+	size_t sp;
+	size_t ep;
+	if (fm == NULL || fm->block == NULL || pattern.size_m == 0) {
+		return 0;
+	}
+	return fm_range(fm, pattern, &sp, &ep);
+}
+
+//! Позиції входжень pattern (до max штук, у порядку суфіксів) в positions.
+//! O(m + occ * MY_STR_FM_SAMPLE). Повертає загальну кількість входжень --
+//! може бути більшою за max.
+size_t my_str_fm_locate(const my_str_fm_t *fm, my_str_view_t pattern, uint32_t *positions, size_t max) {
+	size_t sp;
+	size_t ep;
+	if (fm == NULL || fm->block == NULL || pattern.size_m == 0) {
+		return 0;
+	}
+	size_t total = fm_range(fm, pattern, &sp, &ep);
+	for (size_t k = 0; k < total && k < max; k++) {
+		size_t row = sp + k;
+		uint32_t steps = 0;
+		// Крокуємо LF назад по тексту до збереженої позиції.
+		while (!marked(fm, row)) {
+			unsigned char c = fm->bwt[row];
+			row = (size_t) fm->C[c] + occ(fm, c, row);
+			steps++;
+		}
+		positions[k] = fm->samples[mark_rank(fm, row)] + steps;
+	}
+	return total;
+}
+
+//! Записати індекс у файл -- той самий блок, що в пам'яті.
+//! Файл підмінюється цілим (тимчасовий файл і rename()), тож індекс,
+//! завантажений з path, можна зберегти в path.
+//! -1 -- нульовий вказівник, -2 -- не вдалося відкрити файл, -3 -- помилка запису.
+int my_str_fm_save(const my_str_fm_t *fm, const char *path) {
+	if (fm == NULL || fm->block == NULL || path == NULL) {
+		return -1;
+	}
+	char *tmp;
+	FILE *file = my_str_replace_open(path, &tmp);
+	if (file == NULL) {
+		return -2;
+	}
+	int ok = fwrite(fm->block, fm->block_len, 1, file) == 1;
+	return my_str_replace_commit(file, tmp, path, ok) == 0 ? 0 : -3;
+}
+
+//! Завантажити індекс, збережений my_str_fm_save(): одне mmap(), без розбору.
+//! -1 -- нульовий вказівник, -2 -- не вдалося відкрити чи відобразити файл,
+//! -3 -- файл не цього формату.
+int my_str_fm_load(my_str_fm_t *fm, const char *path) {
+	if (fm == NULL || path == NULL) {
+		return -1;
+	}
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return -2;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(fm_header_t)) {
+		close(fd);
+		return -3;
+	}
+	size_t len = (size_t) st.st_size;
+	void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		return -2;
+	}
+	const fm_header_t *hdr = map;
+	size_t expect = 0;
+	if (memcmp(hdr->magic, FM_MAGIC, 8) == 0 && hdr->version == 1 && hdr->sample == MY_STR_FM_SAMPLE &&
+		hdr->block_len == len && hdr->size < EMPTY - 1 && hdr->nsamples <= hdr->size + 1) {
+		my_str_fm_t probe;
+		probe.block = map;
+		fm_layout(&probe, &expect);
+	}
+	if (expect != len) {
+		munmap(map, len);
+		return -3;
+	}
+	memset(fm, 0, sizeof(*fm));
+	fm->block = map;
+	fm->block_len = len;
+	fm->mapped = 1;
+	fm_layout(fm, NULL);
+	return 0;
+}
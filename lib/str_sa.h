@@ -0,0 +1,49 @@
+#ifndef STRLIB_SA_H
+#define STRLIB_SA_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+
+//! Суфіксний масив тексту (до 4 ГіБ). Текст не копіюється і має жити довше.
+typedef struct
+{
+	my_str_view_t text;
+	uint32_t* sa;	// Початки суфіксів у лексикографічному порядку
+	size_t size_m;
+} my_str_sa_t;
+
+int my_str_sa_create(my_str_sa_t* sa, my_str_view_t text);
+void my_str_sa_free(my_str_sa_t* sa);
+size_t my_str_sa_count(const my_str_sa_t* sa, my_str_view_t pattern);
+size_t my_str_sa_locate(const my_str_sa_t* sa, my_str_view_t pattern, const uint32_t** positions);
+
+#define MY_STR_FM_SAMPLE 32 // Зберігається кожна така позиція суфіксного масиву
+
+//! FM-індекс: BWT тексту з контрольними точками Occ і вибіркою суфіксного масиву.
+//! Сам текст для пошуку не потрібен. Займає ~3.3 байта на символ проти 5
+//! у тексту з суфіксним масивом. Усі частини -- в одному блоці, що так само
+//! лежить і у файлі, тому завантаження -- одне mmap().
+typedef struct
+{
+	size_t size_m;			 // Довжина тексту
+	size_t rows;			 // size_m + 1 (з рядком роздільника)
+	size_t primary;			 // Рядок, у якому суфікс -- весь текст
+	const uint64_t* C;		 // C[c] -- кількість рядків із першим символом < c
+	const uint8_t* bwt;
+	const uint32_t* occ;	 // Кількість кожного символу до кожного 512-го рядка
+	const uint64_t* marks;	 // Біт рядка, позицію якого збережено
+	const uint32_t* mark_rank;
+	const uint32_t* samples; // Збережені позиції, в порядку рядків
+	void* block;			 // Увесь індекс одним блоком
+	size_t block_len;
+	int mapped;				 // Блок -- відображений файл, а не malloc()
+} my_str_fm_t;
+
+int my_str_fm_create(my_str_fm_t* fm, const my_str_sa_t* sa);
+void my_str_fm_free(my_str_fm_t* fm);
+size_t my_str_fm_count(const my_str_fm_t* fm, my_str_view_t pattern);
+size_t my_str_fm_locate(const my_str_fm_t* fm, my_str_view_t pattern, uint32_t* positions, size_t max);
+int my_str_fm_save(const my_str_fm_t* fm, const char* path);
+int my_str_fm_load(my_str_fm_t* fm, const char* path);
+#endif //STRLIB_SA_H
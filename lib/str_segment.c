@@ -0,0 +1,345 @@
+//
+// Сегментація тексту на речення і слова за таблицею класів символів.
+//
+#include <stdlib.h>
+#include <string.h>
+#include "str_segment.h"
+
+//! Класи символів. Для байтів C2 та E2 клас уточнює char_class().
+enum {
+	C_OTHER,
+	C_WORD,	 // Літера, цифра, апостроф, будь-який інший символ UTF-8
+	C_SPACE,
+	C_DOT,	 // . та … (три крапки одним символом)
+	C_BANG,	 // ! та ?
+	C_CLOSE, // Закривні лапки й дужки -- після кінця речення належать йому
+	C_QUOTE, // ’ -- апостроф усередині слова, закривна лапка після нього
+	C_UTF8	 // Початок розділового знака UTF-8, див. char_class()
+};
+
+//! Таблиця класів за першим байтом, по 16 у рядку (праворуч -- перший байт рядка).
+#define O C_OTHER
+#define W C_WORD
+#define S C_SPACE
+#define D C_DOT
+#define B C_BANG
+#define C C_CLOSE
+#define U C_UTF8
+static const unsigned char seg_class[256] = {
+	O, O, O, O, O, O, O, O, O, S, S, S, S, S, O, O, // 00
+	O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, // 10
+	S, B, C, O, O, O, O, W, O, C, O, O, O, O, D, O, // 20
+	W, W, W, W, W, W, W, W, W, W, O, O, O, O, O, B, // 30
+	O, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, // 40
+	W, W, W, W, W, W, W, W, W, W, W, O, O, C, O, O, // 50
+	O, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, // 60
+	W, W, W, W, W, W, W, W, W, W, W, O, O, C, O, O, // 70
+	W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, // 80
+	W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, // 90
+	W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, // A0
+	W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, // B0
+	W, W, U, W, W, W, W, W, W, W, W, W, W, W, W, W, // C0
+	W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, // D0
+	W, W, U, W, W, W, W, W, W, W, W, W, W, W, W, W, // E0
+	W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, // F0
+};
+#undef O
+#undef W
+#undef S
+#undef D
+#undef B
+#undef C
+#undef U
+
+//! Скорочення, після яких крапка не закінчує речення (в нижньому регістрі).
+static const char *const abbreviations[] = {
+	"mr", "mrs", "ms", "dr", "prof", "st", "jr", "sr", "vs", "etc", "no", "fig", "approx", "inc", "ltd",
+	"co", "mt", "jan", "feb", "mar", "apr", "jun", "jul", "aug", "sep", "sept", "oct", "nov", "dec",
+	"вул", "проф", "ім", "див", "напр", "тис", "млн", "млрд", "грн", "ст", "пор", "рис", "табл", "акад",
+};
+
+//! Клас символу в позиції i та його довжина в байтах.
+static int char_class(const unsigned char *p, size_t i, size_t n, size_t *len) {
+	int cls = seg_class[p[i]];
+	*len = 1;
+	if (cls != C_UTF8) {
+		return cls;
+	}
+	if (p[i] == 0xC2 && i + 1 < n) {
+		*len = 2;
+		switch (p[i + 1]) {
+		case 0xA0: return C_SPACE;	// нерозривний пробіл
+		case 0xBB: return C_CLOSE;	// »
+		default: return C_OTHER;	// « та інші знаки Latin-1
+		}
+	}
+	if (p[i] == 0xE2 && i + 2 < n) {
+		*len = 3;
+		if (p[i + 1] == 0x80) {
+			switch (p[i + 2]) {
+			case 0xA6: return C_DOT;	// …
+			case 0x99: return C_QUOTE;	// ’
+			case 0x9D: return C_CLOSE;	// ”
+			default: break;
+			}
+		}
+		return C_OTHER;
+	}
+	return C_WORD;
+}
+
+static int is_digit(unsigned char c) {
+	return (unsigned char) (c - '0') < 10;
+}
+
+//! Кінець слова, що починається в i. Усередині слова допускаються:
+//! дефіс і ’ між символами слова, крапка між цифрами (3.14).
+static size_t scan_word(const unsigned char *p, size_t i, size_t n) {
+	size_t j = i;
+	while (j < n) {
+		size_t len;
+		int cls = char_class(p, j, n, &len);
+		if (cls == C_WORD) {
+			j += len;
+			continue;
+		}
+		size_t next_len;
+		int joins = (cls == C_QUOTE || p[j] == '-') && j > i && j + len < n &&
+					char_class(p, j + len, n, &next_len) == C_WORD;
+		joins = joins || (p[j] == '.' && j > i && is_digit(p[j - 1]) && j + 1 < n && is_digit(p[j + 1]));
+		if (!joins) {
+			break;
+		}
+		j += len;
+	}
+	return j;
+}
+
+//! Чи починається слово з великої літери (латиниця, кирилиця).
+static int is_upper_start(const unsigned char *p, size_t i, size_t n) {
+	unsigned char c = p[i];
+	if (c >= 'A' && c <= 'Z') {
+		return 1;
+	}
+	if (i + 1 >= n) {
+		return 0;
+	}
+	unsigned char d = p[i + 1];
+	return (c == 0xD0 && d >= 0x80 && d <= 0xAF) || (c == 0xD2 && d == 0x90) ||
+		   (c == 0xC3 && d >= 0x80 && d <= 0x9E && d != 0x97);
+}
+
+//! Чи є слово [beg, end) скороченням або однією літерою (ініціал: "J.", "т.").
+static int is_abbreviation(const unsigned char *p, size_t beg, size_t end) {
+	size_t len = end - beg;
+	if (len == 1 && !is_digit(p[beg])) {
+		return 1;
+	}
+	if (len == 2 && p[beg] >= 0xC0) {
+		return 1;
+	}
+	// Регістр: ASCII та кирилиця А-Я (D0 90..AF -> D0 B0..BF, D1 80..8F).
+	char low[16];
+	if (len > sizeof(low)) {
+		return 0;
+	}
+	for (size_t i = 0; i < len; i++) {
+		unsigned char c = p[beg + i];
+		if (c >= 'A' && c <= 'Z') {
+			c |= 0x20;
+		} else if (c == 0xD0 && i + 1 < len && p[beg + i + 1] >= 0x90 && p[beg + i + 1] <= 0xAF) {
+			unsigned char d = p[beg + i + 1];
+			low[i] = (char) (d < 0xA0 ? 0xD0 : 0xD1);
+			low[i + 1] = (char) (d < 0xA0 ? d + 0x20 : d - 0x20);
+			i++;
+			continue;
+		}
+		low[i] = (char) c;
+	}
+	for (size_t k = 0; k < sizeof(abbreviations) / sizeof(abbreviations[0]); k++) {
+		if (strlen(abbreviations[k]) == len && memcmp(abbreviations[k], low, len) == 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+//! Створити порожній результат. Після використання -- my_str_segments_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_segments_create(my_str_segments_t *seg) {
+	if (seg == NULL) {
+		return -1;
+	}
+	memset(seg, 0, sizeof(*seg));
+	seg->cap_words = 64;
+	seg->cap_sentences = 16;
+	seg->words = malloc(sizeof(uint32_t) * 2 * seg->cap_words);
+	seg->sent_first = malloc(sizeof(uint32_t) * (seg->cap_sentences + 1));
+	seg->sent_end = malloc(sizeof(uint32_t) * seg->cap_sentences);
+	if (seg->words == NULL || seg->sent_first == NULL || seg->sent_end == NULL) {
+		my_str_segments_free(seg);
+		return -2;
+	}
+	seg->sent_first[0] = 0;
+	return 0;
+}
+
+void my_str_segments_free(my_str_segments_t *seg) {
+	if (seg == NULL) {
+		return;
+	}
+	free(seg->words);
+	free(seg->sent_first);
+	free(seg->sent_end);
+	memset(seg, 0, sizeof(*seg));
+}
+
+static int push_word(my_str_segments_t *seg, size_t beg, size_t end) {
+	if (seg->nwords == seg->cap_words) {
+		uint32_t *words = realloc(seg->words, sizeof(uint32_t) * 4 * seg->cap_words);
+		if (words == NULL) {
+			return -2;
+		}
+		seg->words = words;
+		seg->cap_words *= 2;
+	}
+	seg->words[2 * seg->nwords] = (uint32_t) beg;
+	seg->words[2 * seg->nwords + 1] = (uint32_t) end;
+	seg->nwords++;
+	return 0;
+}
+
+//! Закрити поточне речення (якщо в ньому є слова) на позиції end.
+static int close_sentence(my_str_segments_t *seg, size_t end) {
+	if (seg->sent_first[seg->nsentences] == seg->nwords) {
+		return 0;
+	}
+	if (seg->nsentences == seg->cap_sentences) {
+		size_t cap = seg->cap_sentences * 2;
+		uint32_t *first = realloc(seg->sent_first, sizeof(uint32_t) * (cap + 1));
+		if (first == NULL) {
+			return -2;
+		}
+		seg->sent_first = first;
+		uint32_t *ends = realloc(seg->sent_end, sizeof(uint32_t) * cap);
+		if (ends == NULL) {
+			return -2;
+		}
+		seg->sent_end = ends;
+		seg->cap_sentences = cap;
+	}
+	seg->sent_end[seg->nsentences] = (uint32_t) end;
+	seg->nsentences++;
+	seg->sent_first[seg->nsentences] = (uint32_t) seg->nwords;
+	return 0;
+}
+
+//! Розбити текст на речення і слова за один прохід (старий вміст seg замінюється).
+//! Речення закінчується серією ! та ? (будь-якою: "?!", "??", "!!!"),
+//! крапкою -- якщо перед нею не скорочення і не ініціал,
+//! трьома крапками (... чи …) -- лише якщо далі слово з великої літери або кінець тексту.
+//! Закривні лапки й дужки після кінця речення входять у речення.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять,
+//! -3 -- текст довший за 4 ГіБ, 0 -- все ОК.
+int my_str_segment(my_str_segments_t *seg, my_str_view_t text) {
+	if (seg == NULL || (text.data == NULL && text.size_m > 0)) {
+		return -1;
+	}
+	if (text.size_m > UINT32_MAX) {
+		return -3;
+	}
+	const unsigned char *p = (const unsigned char *) text.data;
+	size_t n = text.size_m;
+	seg->nwords = 0;
+	seg->nsentences = 0;
+	seg->sent_first[0] = 0;
+
+	size_t pending = 0;	 // Кінець трьох крапок, що ще можуть закінчити речення
+	size_t tail = 0;	 // Кінець останньої серії розділових знаків
+	size_t i = 0;
+	while (i < n) {
+		size_t len;
+		int cls = char_class(p, i, n, &len);
+		if (cls == C_WORD) {
+			size_t end = scan_word(p, i, n);
+			if (pending && is_upper_start(p, i, n) && close_sentence(seg, pending) != 0) {
+				return -2;
+			}
+			pending = 0;
+			if (push_word(seg, i, end) != 0) {
+				return -2;
+			}
+			i = end;
+			continue;
+		}
+		if (cls != C_DOT && cls != C_BANG) {
+			i += len;
+			continue;
+		}
+
+		// Серія розділових знаків, а за нею -- закривні лапки й дужки.
+		size_t run = i;
+		size_t dots = 0;
+		int bang = 0;
+		while (i < n) {
+			cls = char_class(p, i, n, &len);
+			if (cls == C_DOT) {
+				dots += len == 3 ? 3 : 1;
+			} else if (cls == C_BANG) {
+				bang = 1;
+			} else {
+				break;
+			}
+			i += len;
+		}
+		while (i < n) {
+			cls = char_class(p, i, n, &len);
+			if (cls != C_CLOSE && cls != C_QUOTE && p[i] != '\'') {
+				break;
+			}
+			i += len;
+		}
+		tail = i;
+		pending = 0;
+		if (seg->sent_first[seg->nsentences] == seg->nwords) {
+			continue;
+		}
+		if (dots >= 2 && !bang) {
+			pending = i;
+			continue;
+		}
+		if (!bang && seg->words[2 * seg->nwords - 1] == run &&
+			is_abbreviation(p, seg->words[2 * seg->nwords - 2], run)) {
+			continue;
+		}
+		if (close_sentence(seg, i) != 0) {
+			return -2;
+		}
+	}
+	if (seg->nwords > 0) {
+		size_t end = seg->words[2 * seg->nwords - 1];
+		if (tail > end) {
+			end = tail;
+		}
+		if (close_sentence(seg, end) != 0) {
+			return -2;
+		}
+	}
+	return 0;
+}
+
+//! Погляд на index-те слово тексту, за яким будували seg.
+my_str_view_t my_str_segments_word(const my_str_segments_t *seg, my_str_view_t text, size_t index) {
+	if (index >= seg->nwords) {
+		return my_str_view_sub(text, text.size_m, text.size_m);
+	}
+	return my_str_view_sub(text, seg->words[2 * index], seg->words[2 * index + 1]);
+}
+
+//! Погляд на index-те речення: від його першого слова до кінця розділових знаків.
+my_str_view_t my_str_segments_sentence(const my_str_segments_t *seg, my_str_view_t text, size_t index) {
+	if (index >= seg->nsentences) {
+		return my_str_view_sub(text, text.size_m, text.size_m);
+	}
+	return my_str_view_sub(text, seg->words[2 * seg->sent_first[index]], seg->sent_end[index]);
+}
@@ -0,0 +1,26 @@
+#ifndef STRLIB_SEGMENT_H
+#define STRLIB_SEGMENT_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+
+//! Результат сегментації: лише зсуви від початку тексту, жодних нових стрічок.
+//! Текст до 4 ГіБ; більший -- сегментуйте частинами (напр., через my_str_mapreduce()).
+typedef struct
+{
+	uint32_t* words;	   // Слово i -- [words[2i], words[2i + 1])
+	size_t nwords;
+	uint32_t* sent_first;  // Номер першого слова речення i; sent_first[nsentences] == nwords
+	uint32_t* sent_end;	   // Кінець речення i (після розділових знаків і лапок)
+	size_t nsentences;
+	size_t cap_words;
+	size_t cap_sentences;
+} my_str_segments_t;
+
+int my_str_segments_create(my_str_segments_t* seg);
+void my_str_segments_free(my_str_segments_t* seg);
+int my_str_segment(my_str_segments_t* seg, my_str_view_t text);
+my_str_view_t my_str_segments_word(const my_str_segments_t* seg, my_str_view_t text, size_t index);
+my_str_view_t my_str_segments_sentence(const my_str_segments_t* seg, my_str_view_t text, size_t index);
+#endif //STRLIB_SEGMENT_H
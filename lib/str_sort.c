@@ -0,0 +1,358 @@
+//
+// Сортування масивів стрічок: багатоключове швидке сортування з кешем префікса.
+//
+#include <stdlib.h>
+#include <string.h>
+#include "str_sort.h"
+
+//! Стрічка для сортування: 8 байт від поточної глибини -- прямо в записі,
+//! тож більшість порівнянь -- одне порівняння чисел без переходу за вказівником.
+typedef struct {
+	uint64_t cache;	// Байти [depth, depth + 8) у порядку big-endian, 0 за кінцем
+	const unsigned char *ptr;
+	size_t len;
+	uint32_t idx;	// Початковий номер
+} rec_t;
+
+#define SMALL 16
+#define PAR_MIN (1u << 16) // Менші масиви паралельно не сортуються
+
+static uint64_t load_cache(const rec_t *r, size_t depth) {
+	if (r->len >= depth + 8) {
+		uint64_t w;
+		memcpy(&w, r->ptr + depth, 8);
+		return __builtin_bswap64(w);
+	}
+	uint64_t w = 0;
+	for (size_t i = depth; i < depth + 8; i++) {
+		w = w << 8 | (i < r->len ? r->ptr[i] : 0);
+	}
+	return w;
+}
+
+//! Повне порівняння двох стрічок із однаковими першими depth байтами.
+static int rec_cmp(const rec_t *a, const rec_t *b, size_t depth, int stable) {
+	if (a->cache != b->cache) {
+		return a->cache < b->cache ? -1 : 1;
+	}
+	size_t start = depth + 8;
+	size_t la = a->len > start ? a->len - start : 0;
+	size_t lb = b->len > start ? b->len - start : 0;
+	if (la > 0 && lb > 0) {
+		int r = memcmp(a->ptr + start, b->ptr + start, la < lb ? la : lb);
+		if (r != 0) {
+			return r;
+		}
+	}
+	if (a->len != b->len) {
+		return a->len < b->len ? -1 : 1;
+	}
+	if (stable && a->idx != b->idx) {
+		return a->idx < b->idx ? -1 : 1;
+	}
+	return 0;
+}
+
+static void insertion_sort(rec_t *recs, size_t n, size_t depth, int stable) {
+	for (size_t i = 1; i < n; i++) {
+		rec_t r = recs[i];
+		size_t j = i;
+		while (j > 0 && rec_cmp(&recs[j - 1], &r, depth, stable) > 0) {
+			recs[j] = recs[j - 1];
+			j--;
+		}
+		recs[j] = r;
+	}
+}
+
+static int tail_cmp(const void *a, const void *b) {
+	const rec_t *x = a;
+	const rec_t *y = b;
+	if (x->len != y->len) {
+		return x->len < y->len ? -1 : 1;
+	}
+	return (x->idx > y->idx) - (x->idx < y->idx);
+}
+
+static void swap_rec(rec_t *a, rec_t *b) {
+	rec_t t = *a;
+	*a = *b;
+	*b = t;
+}
+
+static uint64_t median3(uint64_t a, uint64_t b, uint64_t c) {
+	if (a > b) {
+		uint64_t t = a;
+		a = b;
+		b = t;
+	}
+	return c < a ? a : (c > b ? b : c);
+}
+
+//! Рівні за кешем на глибині depth: стрічки, що закінчилися в межах кешу, --
+//! префікси решти, тож ідуть першими; між собою відрізняються лише довжиною
+//! (нулі в кінці). Решті кеш перечитується з depth + 8. Повертає кількість перших.
+static size_t equal_advance(rec_t *recs, size_t n, size_t depth) {
+	size_t done = 0;
+	for (size_t k = 0; k < n; k++) {
+		if (recs[k].len <= depth + 8) {
+			swap_rec(&recs[done++], &recs[k]);
+		}
+	}
+	if (done > 1) {
+		qsort(recs, done, sizeof(rec_t), tail_cmp);
+	}
+	for (size_t k = done; k < n; k++) {
+		recs[k].cache = load_cache(&recs[k], depth + 8);
+	}
+	return done;
+}
+
+//! Багатоключове швидке сортування (Бентлі-Седжвік) по 8 байт за раз:
+//! менші й більші за опорний кеш -- на тій самій глибині, рівні -- далі на
+//! глибині depth + 8. Рекурсія -- лише в дві менші з трьох частин, найбільша
+//! обробляється в циклі, тож глибина стеку не перевищує log2(n).
+static void mkqs(rec_t *recs, size_t n, size_t depth, int stable) {
+	while (n > SMALL) {
+		uint64_t pivot = median3(recs[0].cache, recs[n / 2].cache, recs[n - 1].cache);
+		// Розбиття Дейкстри: [0, lt) < pivot, [lt, i) == pivot, (gt, n) > pivot.
+		size_t lt = 0;
+		size_t i = 0;
+		size_t gt = n;
+		while (i < gt) {
+			if (recs[i].cache < pivot) {
+				swap_rec(&recs[lt++], &recs[i++]);
+			} else if (recs[i].cache > pivot) {
+				swap_rec(&recs[i], &recs[--gt]);
+			} else {
+				i++;
+			}
+		}
+		size_t eq = gt - lt;
+		size_t done = equal_advance(recs + lt, eq, depth);
+		if (eq >= lt && eq >= n - gt) {
+			mkqs(recs, lt, depth, stable);
+			mkqs(recs + gt, n - gt, depth, stable);
+			recs += lt + done;
+			n = eq - done;
+			depth += 8;
+		} else {
+			mkqs(recs + lt + done, eq - done, depth + 8, stable);
+			if (lt < n - gt) {
+				mkqs(recs, lt, depth, stable);
+				recs += gt;
+				n -= gt;
+			} else {
+				mkqs(recs + gt, n - gt, depth, stable);
+				n = lt;
+			}
+		}
+	}
+	insertion_sort(recs, n, depth, stable);
+}
+
+//! Паралельний режим -- сортування вибіркою: роздільники беруться з
+//! відсортованої вибірки, кожна стрічка (паралельно) отримує свій кошик,
+//! а кошики сортуються незалежно на потоках пулу. На відміну від розкладу
+//! за першими байтами, не залежить від спільних префіксів (URL, шляхи).
+typedef struct {
+	rec_t *recs;
+	size_t n;
+	const rec_t *splitters;
+	size_t nsplit;
+	uint32_t *bucket;	// Кошик кожної стрічки
+	size_t *bounds;		// Кошик b -- [bounds[b], bounds[b + 1])
+	int stable;
+} par_job_t;
+
+#define PAR_OVERSAMPLE 16
+#define PAR_CHUNK 4096
+
+static void classify(size_t index, size_t worker, void *arg) {
+	(void) worker;
+	par_job_t *job = arg;
+	size_t end = (index + 1) * PAR_CHUNK < job->n ? (index + 1) * PAR_CHUNK : job->n;
+	for (size_t i = index * PAR_CHUNK; i < end; i++) {
+		// Перший роздільник, більший за стрічку; з номером як останнім
+		// ключем повтори теж розходяться по кошиках.
+		size_t lo = 0;
+		size_t hi = job->nsplit;
+		while (lo < hi) {
+			size_t mid = lo + (hi - lo) / 2;
+			if (rec_cmp(&job->splitters[mid], &job->recs[i], 0, 1) <= 0) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		job->bucket[i] = (uint32_t) lo;
+	}
+}
+
+static void sort_bucket(size_t index, size_t worker, void *arg) {
+	(void) worker;
+	par_job_t *job = arg;
+	size_t from = job->bounds[index];
+	mkqs(job->recs + from, job->bounds[index + 1] - from, 0, job->stable);
+}
+
+static int sort_recs(rec_t **precs, size_t n, my_str_pool_t *pool, int stable) {
+	rec_t *recs = *precs;
+	for (size_t i = 0; i < n; i++) {
+		recs[i].cache = load_cache(&recs[i], 0);
+	}
+	if (pool == NULL || my_str_pool_threads(pool) < 2 || n < PAR_MIN) {
+		mkqs(recs, n, 0, stable);
+		return 0;
+	}
+	size_t buckets = my_str_pool_threads(pool) * 8;
+	size_t nsample = buckets * PAR_OVERSAMPLE;
+	rec_t *sample = malloc(sizeof(rec_t) * nsample);
+	rec_t *out = malloc(sizeof(rec_t) * n);
+	uint32_t *bucket = malloc(sizeof(uint32_t) * n);
+	size_t *bounds = calloc(buckets + 1, sizeof(size_t));
+	if (sample == NULL || out == NULL || bucket == NULL || bounds == NULL) {
+		free(sample);
+		free(out);
+		free(bucket);
+		free(bounds);
+		return -2;
+	}
+	for (size_t i = 0; i < nsample; i++) {
+		sample[i] = recs[i * (n / nsample)];
+	}
+	mkqs(sample, nsample, 0, 1);
+	for (size_t b = 0; b + 1 < buckets; b++) {
+		sample[b] = sample[(b + 1) * PAR_OVERSAMPLE - 1];
+	}
+	par_job_t job = {recs, n, sample, buckets - 1, bucket, bounds, stable};
+	my_str_pool_run(pool, (n + PAR_CHUNK - 1) / PAR_CHUNK, classify, &job);
+	for (size_t i = 0; i < n; i++) {
+		bounds[bucket[i] + 1]++;
+	}
+	for (size_t b = 0; b < buckets; b++) {
+		bounds[b + 1] += bounds[b];
+	}
+	for (size_t i = 0; i < n; i++) {
+		out[bounds[bucket[i]]++] = recs[i];
+	}
+	// Після розкладання bounds[b] -- кінець кошика b; зсуваємо на початки.
+	memmove(bounds + 1, bounds, sizeof(size_t) * buckets);
+	bounds[0] = 0;
+	job.recs = out;
+	my_str_pool_run(pool, buckets, sort_bucket, &job);
+	free(sample);
+	free(bucket);
+	free(bounds);
+	free(recs);
+	*precs = out;
+	return 0;
+}
+
+static rec_t *recs_alloc(size_t count) {
+	return malloc(sizeof(rec_t) * (count ? count : 1));
+}
+
+//! Упорядкувати стрічки масиву лексикографічно (як memcmp, коротший
+//! префікс -- раніше). Переставляється лише таблиця, вміст не копіюється;
+//! завантажений масив спершу копіюється у свою пам'ять (my_str_vec_own()).
+//! pool -- NULL для сортування в потоці, що викликає.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять,
+//! -3 -- більше ніж 2^32 - 1 стрічок, 0 -- все ОК.
+int my_str_vec_sort(my_str_vec_t *vec, my_str_pool_t *pool, int flags) {
+	if (vec == NULL) {
+		return -1;
+	}
+	if (vec->size_m >= UINT32_MAX) {
+		return -3;
+	}
+	if (my_str_vec_own(vec) != 0) {
+		return -2;
+	}
+	size_t n = vec->size_m;
+	rec_t *recs = recs_alloc(n);
+	my_str_vec_entry_t *items = malloc(sizeof(my_str_vec_entry_t) * (vec->capacity_m ? vec->capacity_m : 1));
+	if (recs == NULL || items == NULL) {
+		free(recs);
+		free(items);
+		return -2;
+	}
+	for (size_t i = 0; i < n; i++) {
+		recs[i].ptr = (const unsigned char *) vec->blob.data + vec->items[i].off;
+		recs[i].len = (size_t) vec->items[i].size_m;
+		recs[i].idx = (uint32_t) i;
+	}
+	if (sort_recs(&recs, n, pool, flags & MY_STR_SORT_STABLE) != 0) {
+		free(recs);
+		free(items);
+		return -2;
+	}
+	for (size_t i = 0; i < n; i++) {
+		items[i] = vec->items[recs[i].idx];
+	}
+	free(vec->items);
+	vec->items = items;
+	free(recs);
+	return 0;
+}
+
+//! my_str_vec_sort() для масиву my_str_t: переставляються самі структури.
+int my_str_sort(my_str_t *strs, size_t count, my_str_pool_t *pool, int flags) {
+	if (strs == NULL && count > 0) {
+		return -1;
+	}
+	if (count >= UINT32_MAX) {
+		return -3;
+	}
+	rec_t *recs = recs_alloc(count);
+	my_str_t *tmp = malloc(sizeof(my_str_t) * (count ? count : 1));
+	if (recs == NULL || tmp == NULL) {
+		free(recs);
+		free(tmp);
+		return -2;
+	}
+	for (size_t i = 0; i < count; i++) {
+		recs[i].ptr = (const unsigned char *) strs[i].data;
+		recs[i].len = strs[i].size_m;
+		recs[i].idx = (uint32_t) i;
+	}
+	int rc = sort_recs(&recs, count, pool, flags & MY_STR_SORT_STABLE);
+	if (rc == 0) {
+		for (size_t i = 0; i < count; i++) {
+			tmp[i] = strs[recs[i].idx];
+		}
+		memcpy(strs, tmp, sizeof(my_str_t) * count);
+	}
+	free(recs);
+	free(tmp);
+	return rc;
+}
+
+//! my_str_vec_sort() для масиву поглядів.
+int my_str_view_sort(my_str_view_t *views, size_t count, my_str_pool_t *pool, int flags) {
+	if (views == NULL && count > 0) {
+		return -1;
+	}
+	if (count >= UINT32_MAX) {
+		return -3;
+	}
+	rec_t *recs = recs_alloc(count);
+	if (recs == NULL) {
+		return -2;
+	}
+	for (size_t i = 0; i < count; i++) {
+		recs[i].ptr = (const unsigned char *) views[i].data;
+		recs[i].len = views[i].size_m;
+		recs[i].idx = (uint32_t) i;
+	}
+	int rc = sort_recs(&recs, count, pool, flags & MY_STR_SORT_STABLE);
+	if (rc == 0) {
+		// Погляди -- лише вказівник і довжина, їх відновлюємо з записів.
+		for (size_t i = 0; i < count; i++) {
+			views[i].data = (const char *) recs[i].ptr;
+			views[i].size_m = recs[i].len;
+		}
+	}
+	free(recs);
+	return rc;
+}
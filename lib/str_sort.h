@@ -0,0 +1,15 @@
+#ifndef STRLIB_SORT_H
+#define STRLIB_SORT_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+#include "str_vec.h"
+#include "str_parallel.h"
+
+#define MY_STR_SORT_STABLE 1 // Однакові стрічки зберігають початковий порядок
+
+int my_str_vec_sort(my_str_vec_t* vec, my_str_pool_t* pool, int flags);
+int my_str_sort(my_str_t* strs, size_t count, my_str_pool_t* pool, int flags);
+int my_str_view_sort(my_str_view_t* views, size_t count, my_str_pool_t* pool, int flags);
+#endif //STRLIB_SORT_H
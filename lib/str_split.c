@@ -0,0 +1,134 @@
+//
+// Розбиття стрічки на поля без копіювання.
+//
+#include <string.h>
+#include "str_split.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+enum { SPLIT_BY_CHAR, SPLIT_BY_STR, SPLIT_BY_SET };
+
+#define NOT_FOUND ((size_t) -1)
+
+static int in_set(const my_str_split_iter_t *it, unsigned char c) {
+	return it->set[c >> 3] & (1u << (c & 7));
+}
+
+//! Перший символ у [from, n), що належить (want == 1) чи не належить (want == 0) набору.
+static size_t find_set(const my_str_split_iter_t *it, const char *p, size_t from, size_t n, int want) {
+	size_t i = from;
+#ifdef __SSE2__
+	if (it->nchars > 0) {
+		for (; i + 16 <= n; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i *) (p + i));
+			__m128i hit = _mm_setzero_si128();
+			for (size_t k = 0; k < it->nchars; k++) {
+				hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8(it->chars[k])));
+			}
+			unsigned mask = (unsigned) _mm_movemask_epi8(hit);
+			if (!want) {
+				mask = ~mask & 0xFFFF;
+			}
+			if (mask) {
+				return i + (size_t) __builtin_ctz(mask);
+			}
+		}
+	}
+#endif
+	for (; i < n; i++) {
+		if (!in_set(it, (unsigned char) p[i]) == !want) {
+			return i;
+		}
+	}
+	return NOT_FOUND;
+}
+
+static void split_init(my_str_split_iter_t *it, my_str_view_t text, int kind, int flags) {
+	memset(it, 0, sizeof(*it));
+	it->text = text;
+	it->kind = kind;
+	it->flags = flags;
+}
+
+//! Розбивати по одному символу delim.
+void my_str_split_init_c(my_str_split_iter_t *it, my_str_view_t text, char delim, int flags) {
+	split_init(it, text, SPLIT_BY_CHAR, flags);
+	it->chars[0] = delim;
+	it->nchars = 1;
+	it->set[(unsigned char) delim >> 3] |= (unsigned char) (1u << ((unsigned char) delim & 7));
+}
+
+//! Розбивати по підстрічці delim. Порожній delim -- весь текст одним полем.
+//! delim має жити, поки використовується ітератор.
+void my_str_split_init(my_str_split_iter_t *it, my_str_view_t text, my_str_view_t delim, int flags) {
+	if (delim.size_m == 1) {
+		my_str_split_init_c(it, text, delim.data[0], flags);
+		return;
+	}
+	split_init(it, text, SPLIT_BY_STR, flags);
+	it->delim = delim;
+}
+
+//! Розбивати по будь-якому символу С-стрічки set (напр., " \t\n,.!?" -- на слова).
+void my_str_split_init_set(my_str_split_iter_t *it, my_str_view_t text, const char *set, int flags) {
+	split_init(it, text, SPLIT_BY_SET, flags);
+	size_t n = strlen(set);
+	for (size_t i = 0; i < n; i++) {
+		unsigned char c = (unsigned char) set[i];
+		it->set[c >> 3] |= (unsigned char) (1u << (c & 7));
+	}
+	if (n <= MY_STR_SPLIT_SET_SIMD) {
+		memcpy(it->chars, set, n);
+		it->nchars = n;
+	}
+}
+
+//! Наступне поле. Без MY_STR_SPLIT_SKIP_EMPTY полів завжди на одне більше,
+//! ніж роздільників (як у strsep): "a,,b," -- "a", "", "b", "".
+//! Повертає 1 -- поле є, 0 -- поля закінчилися, -1 -- нульовий вказівник.
+int my_str_split_next(my_str_split_iter_t *it, my_str_view_t *field) {
+	if (it == NULL || field == NULL) {
+		return -1;
+	}
+	const char *p = it->text.data;
+	size_t n = it->text.size_m;
+	for (;;) {
+		if (it->done) {
+			return 0;
+		}
+		size_t start = it->pos;
+		size_t end;
+		size_t skip = 1;
+		if (it->kind == SPLIT_BY_STR) {
+			end = it->delim.size_m ? my_str_view_find(it->text, it->delim, start) : NOT_FOUND;
+			skip = it->delim.size_m;
+		} else if (it->kind == SPLIT_BY_CHAR) {
+			const char *hit = start < n ? memchr(p + start, it->chars[0], n - start) : NULL;
+			end = hit ? (size_t) (hit - p) : NOT_FOUND;
+		} else {
+			if ((it->flags & MY_STR_SPLIT_SKIP_EMPTY) && start < n) {
+				// Пропустити всю серію роздільників одним пошуком.
+				start = find_set(it, p, start, n, 0);
+				if (start == NOT_FOUND) {
+					it->done = 1;
+					return 0;
+				}
+			}
+			end = find_set(it, p, start, n, 1);
+		}
+		if (end == NOT_FOUND) {
+			end = n;
+			it->done = 1;
+		} else {
+			it->pos = end + skip;
+		}
+		if (end == start && (it->flags & MY_STR_SPLIT_SKIP_EMPTY)) {
+			continue;
+		}
+		field->data = p + start;
+		field->size_m = end - start;
+		return 1;
+	}
+}
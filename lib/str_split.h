@@ -0,0 +1,29 @@
+#ifndef STRLIB_SPLIT_H
+#define STRLIB_SPLIT_H
+#include <stdio.h>
+#include "stringg.h"
+#include "str_view.h"
+
+#define MY_STR_SPLIT_SKIP_EMPTY 1 // Не віддавати порожніх полів (кілька роздільників підряд -- як один)
+
+#define MY_STR_SPLIT_SET_SIMD 8 // До стількох символів набору -- пошук порівняннями SSE2
+
+//! Ітератор по полях стрічки -- поля віддаються поглядами, без копіювання.
+typedef struct
+{
+	my_str_view_t text;		// Що розбиваємо
+	size_t pos;				// Початок наступного поля
+	my_str_view_t delim;	// Роздільник-підстрічка (для MY_STR_SPLIT_BY_STR)
+	unsigned char set[32];	// Бітова маска набору роздільників
+	char chars[MY_STR_SPLIT_SET_SIMD]; // Набір явно, якщо він малий
+	size_t nchars;
+	int kind;
+	int flags;
+	int done;
+} my_str_split_iter_t;
+
+void my_str_split_init_c(my_str_split_iter_t* it, my_str_view_t text, char delim, int flags);
+void my_str_split_init(my_str_split_iter_t* it, my_str_view_t text, my_str_view_t delim, int flags);
+void my_str_split_init_set(my_str_split_iter_t* it, my_str_view_t text, const char* set, int flags);
+int my_str_split_next(my_str_split_iter_t* it, my_str_view_t* field);
+#endif //STRLIB_SPLIT_H
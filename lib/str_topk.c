@@ -0,0 +1,324 @@
+//
+// Найчастіші слова потоку: Space-Saving на мін-купі з хеш-індексом.
+//
+#include <stdlib.h>
+#include <string.h>
+#include "str_topk.h"
+#include "str_split.h"
+
+#define EMPTY 0
+
+static size_t home_slot(const my_str_topk_t *t, uint64_t hash) {
+	return (size_t) hash & t->index_mask;
+}
+
+static my_str_view_t item_key(const my_str_topk_item_t *item) {
+	return my_str_view(&item->key);
+}
+
+//! Позиція в купі для ключа, або (size_t)(-1).
+static size_t index_find(const my_str_topk_t *t, my_str_view_t key, uint64_t hash) {
+	for (size_t s = home_slot(t, hash);; s = (s + 1) & t->index_mask) {
+		uint32_t e = t->index[s];
+		if (e == EMPTY) {
+			return (size_t) -1;
+		}
+		const my_str_topk_item_t *item = &t->heap[e - 1];
+		if (item->hash == hash && my_str_view_eq(item_key(item), key)) {
+			return e - 1;
+		}
+	}
+}
+
+static void index_insert(my_str_topk_t *t, size_t pos) {
+	size_t s = home_slot(t, t->heap[pos].hash);
+	while (t->index[s] != EMPTY) {
+		s = (s + 1) & t->index_mask;
+	}
+	t->index[s] = (uint32_t) (pos + 1);
+	t->heap[pos].slot = s;
+}
+
+//! Видалити запис зі зсувом наступних назад (лінійне зондування без "надгробків").
+static void index_remove(my_str_topk_t *t, size_t s) {
+	size_t j = s;
+	for (;;) {
+		j = (j + 1) & t->index_mask;
+		uint32_t e = t->index[j];
+		if (e == EMPTY) {
+			break;
+		}
+		size_t home = home_slot(t, t->heap[e - 1].hash);
+		// Запис у j може переїхати в s, лише якщо його "дім" не в (s, j].
+		int stays = s <= j ? (home > s && home <= j) : (home > s || home <= j);
+		if (!stays) {
+			t->index[s] = e;
+			t->heap[e - 1].slot = s;
+			s = j;
+		}
+	}
+	t->index[s] = EMPTY;
+}
+
+static void heap_swap(my_str_topk_t *t, size_t a, size_t b) {
+	my_str_topk_item_t tmp = t->heap[a];
+	t->heap[a] = t->heap[b];
+	t->heap[b] = tmp;
+	t->index[t->heap[a].slot] = (uint32_t) (a + 1);
+	t->index[t->heap[b].slot] = (uint32_t) (b + 1);
+}
+
+//! Лічильник pos лише збільшувався -- опустити його вниз купи.
+static void heap_down(my_str_topk_t *t, size_t pos) {
+	for (;;) {
+		size_t l = 2 * pos + 1;
+		size_t m = pos;
+		if (l < t->size_m && t->heap[l].count < t->heap[m].count) {
+			m = l;
+		}
+		if (l + 1 < t->size_m && t->heap[l + 1].count < t->heap[m].count) {
+			m = l + 1;
+		}
+		if (m == pos) {
+			return;
+		}
+		heap_swap(t, pos, m);
+		pos = m;
+	}
+}
+
+static void heap_up(my_str_topk_t *t, size_t pos) {
+	while (pos > 0 && t->heap[(pos - 1) / 2].count > t->heap[pos].count) {
+		heap_swap(t, pos, (pos - 1) / 2);
+		pos = (pos - 1) / 2;
+	}
+}
+
+//! Створити лічильник k найчастіших слів.
+//! Після використання -- викличте my_str_topk_free().
+//! -1 -- нульовий вказівник чи k == 0, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_topk_create(my_str_topk_t *topk, size_t k) {
+	if (topk == NULL || k == 0 || k >= UINT32_MAX / 2) {
+		return -1;
+	}
+	memset(topk, 0, sizeof(*topk));
+	size_t slots = 2;
+	while (slots < 2 * k) {
+		slots *= 2;
+	}
+	topk->heap = calloc(k, sizeof(my_str_topk_item_t));
+	topk->index = calloc(slots, sizeof(uint32_t));
+	if (topk->heap == NULL || topk->index == NULL) {
+		my_str_topk_free(topk);
+		return -2;
+	}
+	topk->capacity_m = k;
+	topk->index_mask = slots - 1;
+	return 0;
+}
+
+void my_str_topk_free(my_str_topk_t *topk) {
+	if (topk == NULL) {
+		return;
+	}
+	for (size_t i = 0; i < topk->size_m; i++) {
+		my_str_free(&topk->heap[i].key);
+	}
+	free(topk->heap);
+	free(topk->index);
+	memset(topk, 0, sizeof(*topk));
+}
+
+//! my_str_topk_add() з уже обчисленим my_str_hash() ключа
+//! (напр., з генератора n-грам -- щоб не хешувати двічі).
+//! Якщо не вдалося виділити пам'ять (-2), лічильник лишається незмінним.
+int my_str_topk_add_hashed(my_str_topk_t *topk, my_str_view_t key, uint64_t hash, size_t count) {
+	if (topk == NULL || (key.data == NULL && key.size_m > 0)) {
+		return -1;
+	}
+	size_t pos = index_find(topk, key, hash);
+	if (pos != (size_t) -1) {
+		topk->total += count;
+		topk->heap[pos].count += count;
+		heap_down(topk, pos);
+		return 0;
+	}
+	// Місце під копію ключа -- до будь-яких змін купи та індексу.
+	my_str_topk_item_t *item;
+	if (topk->size_m < topk->capacity_m) {
+		my_str_t copy;
+		if (my_str_create(&copy, key.size_m) != 0 || copy.data == NULL) {
+			return -2;
+		}
+		pos = topk->size_m++;
+		item = &topk->heap[pos];
+		item->key = copy;
+		item->count = 0;
+		item->error = 0;
+	} else {
+		// Витіснити найменший лічильник: новий ключ успадковує його значення як похибку.
+		pos = 0;
+		item = &topk->heap[0];
+		if (key.size_m > item->key.capacity_m && my_str_reserve(&item->key, key.size_m) != 0) {
+			return -2;
+		}
+		index_remove(topk, item->slot);
+		item->error = item->count;
+	}
+	my_str_from_view(&item->key, key);
+	topk->total += count;
+	item->hash = hash;
+	item->count += count;
+	index_insert(topk, pos);
+	if (pos == 0) {
+		heap_down(topk, 0);
+	} else {
+		heap_up(topk, pos);
+	}
+	return 0;
+}
+
+//! Додати count входжень слова key.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_topk_add(my_str_topk_t *topk, my_str_view_t key, size_t count) {
+	return my_str_topk_add_hashed(topk, key, my_str_hash(key), count);
+}
+
+//! Розбити text на слова ітератором my_str_split (роздільники -- символи delims)
+//! і додати кожне.
+int my_str_topk_add_words(my_str_topk_t *topk, my_str_view_t text, const char *delims) {
+	my_str_split_iter_t it;
+	my_str_view_t word;
+	my_str_split_init_set(&it, text, delims, MY_STR_SPLIT_SKIP_EMPTY);
+	while (my_str_split_next(&it, &word) == 1) {
+		int rc = my_str_topk_add(topk, word, 1);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+	return 0;
+}
+
+struct merge_candidate {
+	my_str_view_t key;
+	uint64_t hash;
+	size_t count;
+	size_t error;
+};
+
+static int candidate_cmp(const void *a, const void *b) {
+	const struct merge_candidate *x = a;
+	const struct merge_candidate *y = b;
+	return x->count < y->count ? 1 : x->count > y->count ? -1 : 0;
+}
+
+//! Злити from в into (напр., лічильники різних потоків).
+//! Ключ, якого немає в одному з лічильників, отримує його мінімум як похибку
+//! (злиття Space-Saving за Agarwal et al.) -- межі похибки зберігаються.
+//! Обидва мають бути створені з однаковим k.
+//! -1 -- нульовий вказівник чи різні k, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_topk_merge(my_str_topk_t *into, const my_str_topk_t *from) {
+	if (into == NULL || from == NULL || into->capacity_m != from->capacity_m) {
+		return -1;
+	}
+	size_t min_into = into->size_m == into->capacity_m ? into->heap[0].count : 0;
+	size_t min_from = from->size_m == from->capacity_m ? from->heap[0].count : 0;
+	size_t n = 0;
+	struct merge_candidate *c = malloc(sizeof(*c) * (into->size_m + from->size_m));
+	if (c == NULL) {
+		return -2;
+	}
+	for (size_t i = 0; i < into->size_m; i++) {
+		const my_str_topk_item_t *a = &into->heap[i];
+		size_t pos = index_find(from, item_key(a), a->hash);
+		size_t add = pos == (size_t) -1 ? min_from : from->heap[pos].count;
+		size_t err = pos == (size_t) -1 ? min_from : from->heap[pos].error;
+		struct merge_candidate m = {item_key(a), a->hash, a->count + add, a->error + err};
+		c[n++] = m;
+	}
+	for (size_t i = 0; i < from->size_m; i++) {
+		const my_str_topk_item_t *b = &from->heap[i];
+		if (index_find(into, item_key(b), b->hash) == (size_t) -1) {
+			struct merge_candidate m = {item_key(b), b->hash, b->count + min_into, b->error + min_into};
+			c[n++] = m;
+		}
+	}
+	qsort(c, n, sizeof(*c), candidate_cmp);
+	if (n > into->capacity_m) {
+		n = into->capacity_m;
+	}
+
+	// Нова купа: ключі копіюються, бо частина з них живе в into.
+	my_str_topk_item_t *heap = calloc(into->capacity_m, sizeof(*heap));
+	if (heap == NULL) {
+		free(c);
+		return -2;
+	}
+	int rc = 0;
+	for (size_t i = 0; i < n; i++) {
+		my_str_create(&heap[i].key, c[i].key.size_m);
+		if (my_str_from_view(&heap[i].key, c[i].key) != 0) {
+			rc = -2;
+		}
+		heap[i].hash = c[i].hash;
+		heap[i].count = c[i].count;
+		heap[i].error = c[i].error;
+	}
+	free(c);
+	size_t total = into->total + from->total;
+	for (size_t i = 0; i < into->size_m; i++) {
+		my_str_free(&into->heap[i].key);
+	}
+	free(into->heap);
+	into->heap = heap;
+	into->size_m = n;
+	into->total = total;
+	memset(into->index, 0, sizeof(uint32_t) * (into->index_mask + 1));
+	// Відсортований за спаданням масив, розвернутий, -- вже мін-купа.
+	for (size_t i = 0; i < n / 2; i++) {
+		my_str_topk_item_t tmp = heap[i];
+		heap[i] = heap[n - 1 - i];
+		heap[n - 1 - i] = tmp;
+	}
+	for (size_t i = 0; i < n; i++) {
+		index_insert(into, i);
+	}
+	return rc;
+}
+
+static int entry_cmp(const void *a, const void *b) {
+	const my_str_topk_entry_t *x = a;
+	const my_str_topk_entry_t *y = b;
+	return x->count < y->count ? 1 : x->count > y->count ? -1 : 0;
+}
+
+//! Записати до n найчастіших слів в out за спаданням count.
+//! Ключі -- погляди на лічильник, коректні до його наступної зміни.
+//! Повертає кількість записаних.
+size_t my_str_topk_result(const my_str_topk_t *topk, my_str_topk_entry_t *out, size_t n) {
+	if (topk == NULL || out == NULL) {
+		return 0;
+	}
+	my_str_topk_entry_t *all = malloc(sizeof(*all) * (topk->size_m ? topk->size_m : 1));
+	if (all == NULL) {
+		return 0;
+	}
+	for (size_t i = 0; i < topk->size_m; i++) {
+		all[i].key = item_key(&topk->heap[i]);
+		all[i].count = topk->heap[i].count;
+		all[i].error = topk->heap[i].error;
+	}
+	qsort(all, topk->size_m, sizeof(*all), entry_cmp);
+	if (n > topk->size_m) {
+		n = topk->size_m;
+	}
+	memcpy(out, all, sizeof(*all) * n);
+	free(all);
+	return n;
+}
+
+//! Найбільша можлива похибка будь-якого count: total / k.
+//! Кожне слово, що трапилося частіше, гарантовано є серед лічильників.
+size_t my_str_topk_error_bound(const my_str_topk_t *topk) {
+	return topk->total / topk->capacity_m;
+}
@@ -0,0 +1,45 @@
+#ifndef STRLIB_TOPK_H
+#define STRLIB_TOPK_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+
+//! Лічильник алгоритму Space-Saving.
+typedef struct
+{
+	my_str_t key;	// Копія слова
+	uint64_t hash;
+	size_t count;	// Оцінка частоти, не менша за справжню
+	size_t error;	// Справжня частота -- не менша за count - error
+	size_t slot;	// Позиція в хеш-індексі
+} my_str_topk_item_t;
+
+//! Найчастіші слова з обмеженою пам'яттю: рівно capacity_m лічильників,
+//! хоч би скільки різних слів було в потоці.
+typedef struct
+{
+	my_str_topk_item_t* heap; // Мін-купа за count
+	size_t size_m;
+	size_t capacity_m;
+	uint32_t* index;		  // Хеш -> позиція в купі + 1 (0 -- порожньо)
+	size_t index_mask;
+	size_t total;			  // Скільки слів усього додано
+} my_str_topk_t;
+
+typedef struct
+{
+	my_str_view_t key;
+	size_t count;
+	size_t error;
+} my_str_topk_entry_t;
+
+int my_str_topk_create(my_str_topk_t* topk, size_t k);
+void my_str_topk_free(my_str_topk_t* topk);
+int my_str_topk_add(my_str_topk_t* topk, my_str_view_t key, size_t count);
+int my_str_topk_add_hashed(my_str_topk_t* topk, my_str_view_t key, uint64_t hash, size_t count);
+int my_str_topk_add_words(my_str_topk_t* topk, my_str_view_t text, const char* delims);
+int my_str_topk_merge(my_str_topk_t* into, const my_str_topk_t* from);
+size_t my_str_topk_result(const my_str_topk_t* topk, my_str_topk_entry_t* out, size_t n);
+size_t my_str_topk_error_bound(const my_str_topk_t* topk);
+#endif //STRLIB_TOPK_H
@@ -0,0 +1,257 @@
+//
+// Триграмний індекс для пошуку підстрічок у великому масиві стрічок.
+//
+#include <stdlib.h>
+#include <string.h>
+#include "str_trigram.h"
+
+#define NOT_FOUND ((size_t) -1)
+
+static uint32_t gram_at(const char *p) {
+	const unsigned char *u = (const unsigned char *) p;
+	return (uint32_t) u[0] << 16 | (uint32_t) u[1] << 8 | u[2];
+}
+
+static size_t gram_slot(uint32_t gram) {
+	return (size_t) (gram * 0x9E3779B1u);
+}
+
+static size_t list_find(const my_str_trigram_t *idx, uint32_t gram) {
+	for (size_t s = gram_slot(gram) & idx->table_mask;; s = (s + 1) & idx->table_mask) {
+		uint32_t e = idx->table[s];
+		if (e == 0) {
+			return NOT_FOUND;
+		}
+		if (idx->lists[e - 1].gram == gram) {
+			return e - 1;
+		}
+	}
+}
+
+static void table_put(uint32_t *table, size_t mask, uint32_t gram, size_t list) {
+	size_t s = gram_slot(gram) & mask;
+	while (table[s] != 0) {
+		s = (s + 1) & mask;
+	}
+	table[s] = (uint32_t) (list + 1);
+}
+
+static size_t list_insert(my_str_trigram_t *idx, uint32_t gram) {
+	if (2 * (idx->nlists + 1) > idx->table_mask + 1) {
+		size_t size = 2 * (idx->table_mask + 1);
+		uint32_t *table = calloc(size, sizeof(uint32_t));
+		if (table == NULL) {
+			return NOT_FOUND;
+		}
+		for (size_t i = 0; i < idx->nlists; i++) {
+			table_put(table, size - 1, idx->lists[i].gram, i);
+		}
+		free(idx->table);
+		idx->table = table;
+		idx->table_mask = size - 1;
+	}
+	if (idx->nlists == idx->cap_lists) {
+		size_t cap = idx->cap_lists * 2;
+		my_str_trigram_list_t *lists = realloc(idx->lists, sizeof(*lists) * cap);
+		if (lists == NULL) {
+			return NOT_FOUND;
+		}
+		idx->lists = lists;
+		idx->cap_lists = cap;
+	}
+	size_t id = idx->nlists++;
+	memset(&idx->lists[id], 0, sizeof(my_str_trigram_list_t));
+	idx->lists[id].gram = gram;
+	table_put(idx->table, idx->table_mask, gram, id);
+	return id;
+}
+
+static int list_push(my_str_trigram_list_t *list, uint32_t id) {
+	// Стрічки індексуються по порядку -- повтор триграми в тій самій стрічці
+	// завжди в кінці списку.
+	if (list->size_m > 0 && list->ids[list->size_m - 1] == id) {
+		return 0;
+	}
+	if (list->size_m == list->capacity_m) {
+		uint32_t cap = list->capacity_m ? list->capacity_m * 2 : 4;
+		uint32_t *ids = realloc(list->ids, sizeof(uint32_t) * cap);
+		if (ids == NULL) {
+			return -2;
+		}
+		list->ids = ids;
+		list->capacity_m = cap;
+	}
+	list->ids[list->size_m++] = id;
+	return 0;
+}
+
+//! Створити індекс над vec і проіндексувати його поточний вміст.
+//! Після використання -- викличте my_str_trigram_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_trigram_create(my_str_trigram_t *idx, const my_str_vec_t *vec) {
+	if (idx == NULL || vec == NULL) {
+		return -1;
+	}
+	memset(idx, 0, sizeof(*idx));
+	idx->vec = vec;
+	idx->cap_lists = 256;
+	idx->table_mask = 511;
+	idx->lists = malloc(sizeof(my_str_trigram_list_t) * idx->cap_lists);
+	idx->table = calloc(idx->table_mask + 1, sizeof(uint32_t));
+	if (idx->lists == NULL || idx->table == NULL) {
+		my_str_trigram_free(idx);
+		return -2;
+	}
+	return my_str_trigram_update(idx);
+}
+
+void my_str_trigram_free(my_str_trigram_t *idx) {
+	if (idx == NULL) {
+		return;
+	}
+	for (size_t i = 0; i < idx->nlists; i++) {
+		free(idx->lists[i].ids);
+	}
+	free(idx->lists);
+	free(idx->table);
+	memset(idx, 0, sizeof(*idx));
+}
+
+//! Дописати в індекс стрічки, додані у vec після останнього оновлення.
+//! Вже проіндексовані не переглядаються -- вартість пропорційна лише новим.
+//! -2 -- не вдалося виділити пам'ять, -3 -- забагато стрічок, 0 -- все ОК.
+int my_str_trigram_update(my_str_trigram_t *idx) {
+	size_t n = my_str_vec_size(idx->vec);
+	if (n > UINT32_MAX) {
+		return -3;
+	}
+	for (; idx->indexed < n; idx->indexed++) {
+		my_str_view_t s = my_str_vec_get(idx->vec, idx->indexed);
+		for (size_t i = 0; i + 3 <= s.size_m; i++) {
+			uint32_t gram = gram_at(s.data + i);
+			size_t list = list_find(idx, gram);
+			if (list == NOT_FOUND && (list = list_insert(idx, gram)) == NOT_FOUND) {
+				return -2;
+			}
+			if (list_push(&idx->lists[list], (uint32_t) idx->indexed) != 0) {
+				return -2;
+			}
+		}
+	}
+	return 0;
+}
+
+static int list_cmp(const void *a, const void *b) {
+	const my_str_trigram_list_t *x = *(const my_str_trigram_list_t *const *) a;
+	const my_str_trigram_list_t *y = *(const my_str_trigram_list_t *const *) b;
+	if (x->size_m != y->size_m) {
+		return x->size_m < y->size_m ? -1 : 1;
+	}
+	// Усі списки -- з одного масиву idx->lists, тож адреси порівнювані;
+	// однакові списки після сортування стоять поруч.
+	return x < y ? -1 : x > y;
+}
+
+//! Чи є id у відсортованому списку, починаючи з *from (галопом; *from рухається вперед).
+static int list_has(const my_str_trigram_list_t *list, uint32_t id, size_t *from) {
+	size_t lo = *from;
+	size_t hi = lo;
+	size_t step = 1;
+	while (hi < list->size_m && list->ids[hi] < id) {
+		lo = hi + 1;
+		hi += step;
+		step *= 2;
+	}
+	if (hi > list->size_m) {
+		hi = list->size_m;
+	}
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (list->ids[mid] < id) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	*from = lo;
+	return lo < list->size_m && list->ids[lo] == id;
+}
+
+static int push_id(my_str_invidx_result_t *res, uint32_t id) {
+	if (res->size_m == res->capacity_m) {
+		size_t cap = res->capacity_m ? res->capacity_m * 2 : 64;
+		uint32_t *docs = realloc(res->docs, sizeof(uint32_t) * cap);
+		if (docs == NULL) {
+			return -2;
+		}
+		res->docs = docs;
+		res->capacity_m = cap;
+	}
+	res->docs[res->size_m++] = id;
+	return 0;
+}
+
+//! Номери стрічок vec, що містять tofind (за зростанням; результат у res замінюється).
+//! Спершу дописує в індекс нові стрічки vec. Кандидати -- перетин списків усіх
+//! триграм tofind, кожен перевіряється my_str_view_find().
+//! Для tofind коротших за 3 байти індекс не допомагає -- перевіряються всі стрічки.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять,
+//! -3 -- у vec забагато стрічок для індексу (див. my_str_trigram_update()), 0 -- все ОК.
+int my_str_trigram_find(my_str_trigram_t *idx, my_str_view_t tofind, my_str_invidx_result_t *res) {
+	if (idx == NULL || res == NULL || (tofind.data == NULL && tofind.size_m > 0)) {
+		return -1;
+	}
+	res->size_m = 0;
+	int rc = my_str_trigram_update(idx);
+	if (rc != 0) {
+		return rc;
+	}
+	if (tofind.size_m < 3) {
+		for (size_t i = 0; i < idx->indexed; i++) {
+			if (my_str_view_find(my_str_vec_get(idx->vec, i), tofind, 0) != NOT_FOUND && push_id(res, (uint32_t) i) != 0) {
+				return -2;
+			}
+		}
+		return 0;
+	}
+
+	size_t ngrams = tofind.size_m - 2;
+	const my_str_trigram_list_t **lists = malloc(sizeof(*lists) * ngrams);
+	size_t *pos = calloc(ngrams, sizeof(size_t));
+	if (lists == NULL || pos == NULL) {
+		free(lists);
+		free(pos);
+		return -2;
+	}
+	size_t n = 1;
+	for (size_t i = 0; i < ngrams; i++) {
+		size_t list = list_find(idx, gram_at(tofind.data + i));
+		if (list == NOT_FOUND) {
+			goto out;
+		}
+		lists[i] = &idx->lists[list];
+	}
+	// Від коротших списків до довших; однакові триграми в tofind дають
+	// той самий список -- після сортування лишається один.
+	qsort(lists, ngrams, sizeof(*lists), list_cmp);
+	for (size_t i = 1; i < ngrams; i++) {
+		if (lists[i] != lists[n - 1]) {
+			lists[n++] = lists[i];
+		}
+	}
+	for (size_t k = 0; k < lists[0]->size_m; k++) {
+		uint32_t id = lists[0]->ids[k];
+		int all = 1;
+		for (size_t j = 1; j < n && all; j++) {
+			all = list_has(lists[j], id, &pos[j]);
+		}
+		if (all && my_str_view_find(my_str_vec_get(idx->vec, id), tofind, 0) != NOT_FOUND && push_id(res, id) != 0) {
+			rc = -2;
+			break;
+		}
+	}
+out:
+	free(pos);
+	free(lists);
+	return rc;
+}
@@ -0,0 +1,35 @@
+#ifndef STRLIB_TRIGRAM_H
+#define STRLIB_TRIGRAM_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+#include "str_vec.h"
+#include "str_invidx.h"
+
+//! Номери стрічок, що містять триграму, за зростанням.
+typedef struct
+{
+	uint32_t gram;	 // Три байти триграми
+	uint32_t size_m;
+	uint32_t capacity_m;
+	uint32_t* ids;
+} my_str_trigram_list_t;
+
+//! Триграмний індекс над my_str_vec_t (масив не копіюється і має жити довше).
+typedef struct
+{
+	const my_str_vec_t* vec;
+	size_t indexed;				   // Скільки перших стрічок vec уже в індексі
+	my_str_trigram_list_t* lists;
+	size_t nlists;
+	size_t cap_lists;
+	uint32_t* table;			   // Триграма -> номер списку + 1 (0 -- порожньо)
+	size_t table_mask;
+} my_str_trigram_t;
+
+int my_str_trigram_create(my_str_trigram_t* idx, const my_str_vec_t* vec);
+void my_str_trigram_free(my_str_trigram_t* idx);
+int my_str_trigram_update(my_str_trigram_t* idx);
+int my_str_trigram_find(my_str_trigram_t* idx, my_str_view_t tofind, my_str_invidx_result_t* res);
+#endif //STRLIB_TRIGRAM_H
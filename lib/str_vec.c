@@ -0,0 +1,310 @@
+//
+// Масив стрічок у спільному блоці та його двійковий файловий формат.
+//
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "str_vec.h"
+#include "str_file.h"
+
+//! Формат файлу (усі числа -- uint64_t у порядку байтів машини, що писала):
+//!   заголовок my_str_vec_header_t,
+//!   count записів my_str_vec_entry_t,
+//!   blob_size байт вмісту.
+//! Порядок байтів перевіряється за полем version.
+#define MY_STR_VEC_MAGIC "MYSTRVEC"
+#define MY_STR_VEC_VERSION 1
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t header_size;
+	uint64_t count;
+	uint64_t blob_size;
+	uint64_t checksum; // vec_checksum() таблиці, а потім блоку
+	uint64_t reserved;
+} my_str_vec_header_t;
+
+//! Проста 64-бітна контрольна сума, по 8 байт за крок.
+//! Може продовжуватися наступним викликом, якщо len кратне 8.
+static uint64_t vec_checksum(uint64_t h, const char *data, size_t len) {
+	const uint64_t prime = 0x9E3779B97F4A7C15ull;
+	size_t i = 0;
+	for (; i + 8 <= len; i += 8) {
+		uint64_t w;
+		memcpy(&w, data + i, 8);
+		h = (h ^ w) * prime;
+		h ^= h >> 31;
+	}
+	if (i < len) {
+		uint64_t w = 0;
+		memcpy(&w, data + i, len - i);
+		h = (h ^ w ^ (uint64_t) (len - i) << 56) * prime;
+		h ^= h >> 31;
+	}
+	return h;
+}
+
+static const char *vec_blob(const my_str_vec_t *vec) {
+	return vec->map ? vec->map_blob : vec->blob.data;
+}
+
+//! Зняти відображення файлу, нічого не копіюючи.
+static void vec_unmap(my_str_vec_t *vec) {
+	if (vec->map != NULL) {
+		munmap(vec->map, vec->map_len);
+		vec->map = NULL;
+		vec->map_blob = NULL;
+		vec->map_len = 0;
+		vec->items = NULL;
+		vec->capacity_m = 0;
+	}
+}
+
+//! Створити порожній масив із місцем для count стрічок.
+//! Після використання -- викличте my_str_vec_free().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_vec_create(my_str_vec_t *vec, size_t count) {
+	if (vec == NULL) {
+		return -1;
+	}
+	memset(vec, 0, sizeof(*vec));
+	my_str_create(&vec->blob, 0);
+	vec->items = malloc(sizeof(my_str_vec_entry_t) * (count ? count : 1));
+	if (vec->blob.data == NULL || vec->items == NULL) {
+		my_str_vec_free(vec);
+		return -2;
+	}
+	vec->capacity_m = count ? count : 1;
+	return 0;
+}
+
+//! Звільнити пам'ять (або зняти відображення файлу).
+void my_str_vec_free(my_str_vec_t *vec) {
+	if (vec == NULL) {
+		return;
+	}
+	if (vec->map != NULL) {
+		vec_unmap(vec);
+	} else {
+		free(vec->items);
+	}
+	my_str_free(&vec->blob);
+	vec->items = NULL;
+	vec->size_m = 0;
+	vec->capacity_m = 0;
+}
+
+//! Зробити масив порожнім. Буфери (якщо свої) залишаються.
+void my_str_vec_clear(my_str_vec_t *vec) {
+	if (vec->map != NULL) {
+		vec_unmap(vec);
+	}
+	vec->blob.size_m = 0;
+	vec->size_m = 0;
+}
+
+size_t my_str_vec_size(const my_str_vec_t *vec) {
+	return vec ? vec->size_m : 0;
+}
+
+//! Погляд на index-ту стрічку; за межами -- порожній погляд.
+//! Коректний до наступної зміни масиву.
+my_str_view_t my_str_vec_get(const my_str_vec_t *vec, size_t index) {
+	my_str_view_t view = {NULL, 0};
+	if (vec != NULL && index < vec->size_m) {
+		view.data = vec_blob(vec) + vec->items[index].off;
+		view.size_m = (size_t) vec->items[index].size_m;
+	}
+	return view;
+}
+
+//! Перед першою зміною завантаженого масиву -- скопіювати його у свою пам'ять.
+//! Для масиву, що й так у своїй пам'яті, нічого не робить.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_vec_own(my_str_vec_t *vec) {
+	if (vec == NULL) {
+		return -1;
+	}
+	if (vec->map == NULL) {
+		return 0;
+	}
+	size_t count = vec->size_m ? vec->size_m : 1;
+	my_str_vec_entry_t *items = malloc(sizeof(*items) * count);
+	uint64_t blob_size = 0;
+	for (size_t i = 0; i < vec->size_m; i++) {
+		blob_size += vec->items[i].size_m;
+	}
+	if (items == NULL || (blob_size > vec->blob.capacity_m && my_str_reserve(&vec->blob, (size_t) blob_size) != 0)) {
+		free(items);
+		return -2;
+	}
+	vec->blob.size_m = 0;
+	for (size_t i = 0; i < vec->size_m; i++) {
+		my_str_view_t s = my_str_vec_get(vec, i);
+		memcpy(vec->blob.data + vec->blob.size_m, s.data, s.size_m);
+		items[i].off = vec->blob.size_m;
+		items[i].size_m = s.size_m;
+		vec->blob.size_m += s.size_m;
+	}
+	size_t size = vec->size_m;
+	vec_unmap(vec);
+	vec->items = items;
+	vec->size_m = size;
+	vec->capacity_m = count;
+	return 0;
+}
+
+//! Додати копію стрічки в кінець масиву.
+//! Блок і таблиця збільшуються вдвічі за потреби.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_vec_push(my_str_vec_t *vec, my_str_view_t str) {
+	if (vec == NULL || (str.data == NULL && str.size_m > 0)) {
+		return -1;
+	}
+	if (my_str_vec_own(vec) != 0) {
+		return -2;
+	}
+	if (vec->size_m == vec->capacity_m) {
+		size_t cap = vec->capacity_m ? vec->capacity_m * 2 : 8;
+		my_str_vec_entry_t *items = realloc(vec->items, sizeof(*items) * cap);
+		if (items == NULL) {
+			return -2;
+		}
+		vec->items = items;
+		vec->capacity_m = cap;
+	}
+	my_str_t *blob = &vec->blob;
+	if (blob->size_m + str.size_m > blob->capacity_m) {
+		size_t cap = blob->capacity_m * 2;
+		if (cap < blob->size_m + str.size_m) {
+			cap = blob->size_m + str.size_m;
+		}
+		if (my_str_reserve(blob, cap) != 0 || blob->data == NULL) {
+			return -2;
+		}
+	}
+	memcpy(blob->data + blob->size_m, str.data, str.size_m);
+	vec->items[vec->size_m].off = blob->size_m;
+	vec->items[vec->size_m].size_m = str.size_m;
+	blob->size_m += str.size_m;
+	vec->size_m++;
+	return 0;
+}
+
+//! my_str_vec_push() для my_str_t.
+int my_str_vec_push_str(my_str_vec_t *vec, const my_str_t *str) {
+	if (str == NULL) {
+		return -1;
+	}
+	return my_str_vec_push(vec, my_str_view(str));
+}
+
+//!===========================================================================
+//! Збереження та завантаження
+//!===========================================================================
+
+//! Записати масив у файл двійкового формату (див. вище).
+//! Файл підмінюється цілим (тимчасовий файл і rename()), тож можна
+//! зберегти масив, завантажений my_str_vec_load(), за тим самим шляхом.
+//! -1 -- нульовий вказівник, -2 -- не вдалося відкрити файл, -3 -- помилка запису.
+int my_str_vec_save(const my_str_vec_t *vec, const char *path) {
+	if (vec == NULL || path == NULL) {
+		return -1;
+	}
+	my_str_vec_header_t hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, MY_STR_VEC_MAGIC, 8);
+	hdr.version = MY_STR_VEC_VERSION;
+	hdr.header_size = sizeof(hdr);
+	hdr.count = vec->size_m;
+	// Завантажений чи відсортований масив може мати "дірки" в блоці --
+	// записуємо його як є, зсуви в таблиці залишаються правильними.
+	uint64_t blob_size = 0;
+	for (size_t i = 0; i < vec->size_m; i++) {
+		if (vec->items[i].off + vec->items[i].size_m > blob_size) {
+			blob_size = vec->items[i].off + vec->items[i].size_m;
+		}
+	}
+	hdr.blob_size = blob_size;
+	size_t table = sizeof(my_str_vec_entry_t) * vec->size_m;
+	hdr.checksum = vec_checksum(0, (const char *) vec->items, table);
+	hdr.checksum = vec_checksum(hdr.checksum, vec_blob(vec), (size_t) blob_size);
+
+	char *tmp;
+	FILE *file = my_str_replace_open(path, &tmp);
+	if (file == NULL) {
+		return -2;
+	}
+	int ok = fwrite(&hdr, sizeof(hdr), 1, file) == 1 &&
+			 (table == 0 || fwrite(vec->items, table, 1, file) == 1) &&
+			 (blob_size == 0 || fwrite(vec_blob(vec), (size_t) blob_size, 1, file) == 1);
+	return my_str_replace_commit(file, tmp, path, ok) == 0 ? 0 : -3;
+}
+
+//! Завантажити масив, збережений my_str_vec_save(), замінивши вміст vec.
+//! Файл відображається в пам'ять; стрічки не розбираються і не копіюються --
+//! кожна стає доступною одразу, як погляд у відображення.
+//! Без MY_STR_VEC_VERIFY перевіряються лише заголовок і розмір файлу (O(1)).
+//! -1 -- нульовий вказівник, -2 -- не вдалося відкрити чи відобразити файл,
+//! -3 -- файл не цього формату або пошкоджений.
+int my_str_vec_load(my_str_vec_t *vec, const char *path, int flags) {
+	if (vec == NULL || path == NULL) {
+		return -1;
+	}
+	if (sizeof(size_t) < sizeof(uint64_t)) {
+		return -3;
+	}
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return -2;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(my_str_vec_header_t)) {
+		close(fd);
+		return -3;
+	}
+	size_t len = (size_t) st.st_size;
+	void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		return -2;
+	}
+
+	const my_str_vec_header_t *hdr = map;
+	const char *table = (const char *) map + sizeof(*hdr);
+	int ok = memcmp(hdr->magic, MY_STR_VEC_MAGIC, 8) == 0 &&
+			 hdr->version == MY_STR_VEC_VERSION && hdr->header_size == sizeof(*hdr) &&
+			 hdr->count <= (len - sizeof(*hdr)) / sizeof(my_str_vec_entry_t) &&
+			 sizeof(*hdr) + hdr->count * sizeof(my_str_vec_entry_t) + hdr->blob_size == len;
+	if (ok && (flags & MY_STR_VEC_VERIFY)) {
+		size_t table_len = (size_t) hdr->count * sizeof(my_str_vec_entry_t);
+		const my_str_vec_entry_t *items = (const my_str_vec_entry_t *) table;
+		uint64_t sum = vec_checksum(0, table, table_len);
+		ok = vec_checksum(sum, table + table_len, (size_t) hdr->blob_size) == hdr->checksum;
+		for (size_t i = 0; ok && i < hdr->count; i++) {
+			ok = items[i].size_m <= hdr->blob_size && items[i].off <= hdr->blob_size - items[i].size_m;
+		}
+	}
+	if (!ok) {
+		munmap(map, len);
+		return -3;
+	}
+
+	if (vec->map != NULL) {
+		vec_unmap(vec);
+	} else {
+		free(vec->items);
+	}
+	vec->blob.size_m = 0;
+	vec->map = map;
+	vec->map_len = len;
+	vec->items = (my_str_vec_entry_t *) table;
+	vec->map_blob = table + hdr->count * sizeof(my_str_vec_entry_t);
+	vec->size_m = (size_t) hdr->count;
+	vec->capacity_m = vec->size_m;
+	return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef STRLIB_VEC_H
+#define STRLIB_VEC_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+#include "str_view.h"
+
+//! Положення i-ї стрічки в спільному блоці.
+typedef struct
+{
+	uint64_t off;	 // Зсув від початку блоку
+	uint64_t size_m; // Довжина
+} my_str_vec_entry_t;
+
+//! Масив стрічок, збережених підряд в одному блоці.
+//! Після my_str_vec_load() і блок, і таблиця вказують просто
+//! у відображений файл -- до першої зміни масиву.
+typedef struct
+{
+	my_str_t blob;				// Вміст усіх стрічок підряд
+	my_str_vec_entry_t* items;	// Таблиця стрічок
+	size_t size_m;				// Кількість стрічок
+	size_t capacity_m;			// Розмір таблиці
+	const char* map_blob;		// Блок у відображеному файлі, або NULL
+	void* map;					// Відображення файлу, або NULL
+	size_t map_len;
+} my_str_vec_t;
+
+int my_str_vec_create(my_str_vec_t* vec, size_t count);
+void my_str_vec_free(my_str_vec_t* vec);
+void my_str_vec_clear(my_str_vec_t* vec);
+size_t my_str_vec_size(const my_str_vec_t* vec);
+my_str_view_t my_str_vec_get(const my_str_vec_t* vec, size_t index);
+int my_str_vec_push(my_str_vec_t* vec, my_str_view_t str);
+int my_str_vec_push_str(my_str_vec_t* vec, const my_str_t* str);
+int my_str_vec_own(my_str_vec_t* vec);
+
+#define MY_STR_VEC_VERIFY 1 // Перевірити контрольну суму та межі всіх стрічок
+
+int my_str_vec_save(const my_str_vec_t* vec, const char* path);
+int my_str_vec_load(my_str_vec_t* vec, const char* path, int flags);
+#endif //STRLIB_VEC_H
@@ -0,0 +1,164 @@
+//
+// Погляди (view) на стрічки -- підстрічки без копіювання.
+//
+#define _GNU_SOURCE
+#include <string.h>
+#include "str_view.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//! Погляд на весь вміст стрічки.
+//! Для нульового вказівника -- порожній погляд.
+my_str_view_t my_str_view(const my_str_t *str) {
+	my_str_view_t view = {NULL, 0};
+	if (str != NULL) {
+		view.data = str->data;
+		view.size_m = str->size_m;
+	}
+	return view;
+}
+
+//! Погляд на С-стрічку, без завершального нуля.
+my_str_view_t my_str_view_cstr(const char *cstr) {
+	my_str_view_t view = {cstr, cstr ? strlen(cstr) : 0};
+	return view;
+}
+
+//! Підпогляд [beg, end), аналог my_str_substr(), але без копіювання.
+//! end за межами -- обрізається, beg за межами -- порожній погляд.
+my_str_view_t my_str_view_sub(my_str_view_t view, size_t beg, size_t end) {
+	if (end > view.size_m) {
+		end = view.size_m;
+	}
+	if (beg > end) {
+		beg = end;
+	}
+	view.data += beg;
+	view.size_m = end - beg;
+	return view;
+}
+
+//! Скопіювати вміст погляду у стрічку (старий вміст замінюється).
+//! Буфер збільшується за потреби, одним викликом my_str_reserve().
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_from_view(my_str_t *str, my_str_view_t view) {
+	if (str == NULL) {
+		return -1;
+	}
+	if (view.size_m > str->capacity_m) {
+		my_str_reserve(str, view.size_m);
+		if (str->data == NULL || str->capacity_m < view.size_m) {
+			return -2;
+		}
+	}
+	if (view.size_m > 0) {
+		memmove(str->data, view.data, view.size_m);
+	}
+	str->size_m = view.size_m;
+	return 0;
+}
+
+//! Дописати вміст погляду в кінець стрічки одним memcpy().
+//! Буфер росте щонайменше вдвічі, тож серія дописувань -- амортизовано
+//! лінійна. view може вказувати і на саму str.
+//! -1 -- нульовий вказівник, -2 -- не вдалося виділити пам'ять, 0 -- все ОК.
+int my_str_append_view(my_str_t *str, my_str_view_t view) {
+	if (str == NULL || (view.data == NULL && view.size_m > 0)) {
+		return -1;
+	}
+	if (view.size_m == 0) {
+		return 0;
+	}
+	size_t need = str->size_m + view.size_m;
+	if (need > str->capacity_m) {
+		size_t cap = str->capacity_m * 2;
+		if (cap < need) {
+			cap = need;
+		}
+		// Погляд на власний буфер переживає реалокацію як зсув.
+		uintptr_t beg = (uintptr_t) str->data;
+		uintptr_t at = (uintptr_t) view.data;
+		int inside = str->data != NULL && at >= beg && at < beg + str->capacity_m;
+		if (my_str_reserve(str, cap) != 0) {
+			return -2;
+		}
+		if (inside) {
+			view.data = str->data + (at - beg);
+		}
+	}
+	memcpy(str->data + str->size_m, view.data, view.size_m);
+	str->size_m = need;
+	return 0;
+}
+
+//! Чи рівні погляди за вмістом.
+int my_str_view_eq(my_str_view_t a, my_str_view_t b) {
+	return a.size_m == b.size_m && (a.size_m == 0 || memcmp(a.data, b.data, a.size_m) == 0);
+}
+
+//! Аналог my_str_find() для поглядів: перше входження tofind, починаючи з from,
+//! або (size_t)(-1). Порожній tofind знаходиться одразу в from.
+//! Блоками по 16: кандидати -- збіг і першого, і останнього символу tofind,
+//! лише їх перевіряємо повністю.
+size_t my_str_view_find(my_str_view_t str, my_str_view_t tofind, size_t from) {
+	const char *p = str.data;
+	size_t n = str.size_m;
+	size_t m = tofind.size_m;
+	if (from > n || n - from < m) {
+		return (size_t) -1;
+	}
+	if (m == 0) {
+		return from;
+	}
+	if (m == 1) {
+		const char *hit = memchr(p + from, tofind.data[0], n - from);
+		return hit ? (size_t) (hit - p) : (size_t) -1;
+	}
+	size_t i = from;
+#ifdef __SSE2__
+	__m128i first = _mm_set1_epi8(tofind.data[0]);
+	__m128i last = _mm_set1_epi8(tofind.data[m - 1]);
+	for (; i + m - 1 + 16 <= n; i += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i *) (p + i));
+		__m128i b = _mm_loadu_si128((const __m128i *) (p + i + m - 1));
+		unsigned mask = (unsigned) _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+		while (mask) {
+			size_t k = i + (size_t) __builtin_ctz(mask);
+			if (memcmp(p + k + 1, tofind.data + 1, m - 2) == 0) {
+				return k;
+			}
+			mask &= mask - 1;
+		}
+	}
+#endif
+	const char *hit = memmem(p + i, n - i, tofind.data, m);
+	return hit ? (size_t) (hit - p) : (size_t) -1;
+}
+
+static uint64_t hash_mix(uint64_t a, uint64_t b) {
+	__uint128_t r = (__uint128_t) a * b;
+	return (uint64_t) r ^ (uint64_t) (r >> 64);
+}
+
+//! 64-бітний хеш вмісту -- по 8 байт за крок, з множенням 64x64->128.
+//! Не криптографічний; для хеш-таблиць, скетчів і дедуплікації.
+uint64_t my_str_hash(my_str_view_t view) {
+	const uint64_t k0 = 0xA0761D6478BD642Full;
+	const uint64_t k1 = 0xE7037ED1A0B428DBull;
+	const char *p = view.data;
+	size_t n = view.size_m;
+	uint64_t h = k0 ^ (uint64_t) n;
+	for (; n >= 8; p += 8, n -= 8) {
+		uint64_t w;
+		memcpy(&w, p, 8);
+		h = hash_mix(h ^ w, k1);
+	}
+	if (n > 0) {
+		uint64_t w = 0;
+		memcpy(&w, p, n);
+		h = hash_mix(h ^ w, k1 ^ (uint64_t) n);
+	}
+	return hash_mix(h, k0);
+}
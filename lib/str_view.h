@@ -0,0 +1,23 @@
+#ifndef STRLIB_VIEW_H
+#define STRLIB_VIEW_H
+#include <stdio.h>
+#include <stdint.h>
+#include "stringg.h"
+
+//! Незмінний "погляд" на чужий блок пам'яті -- без власного буфера.
+//! Живе не довше, ніж стрічка чи файл, на які вказує.
+typedef struct
+{
+	const char* data; // Вказівник на перший символ
+	size_t size_m;	  // Кількість символів
+} my_str_view_t;
+
+my_str_view_t my_str_view(const my_str_t* str);
+my_str_view_t my_str_view_cstr(const char* cstr);
+my_str_view_t my_str_view_sub(my_str_view_t view, size_t beg, size_t end);
+int my_str_from_view(my_str_t* str, my_str_view_t view);
+int my_str_append_view(my_str_t* str, my_str_view_t view);
+int my_str_view_eq(my_str_view_t a, my_str_view_t b);
+size_t my_str_view_find(my_str_view_t str, my_str_view_t tofind, size_t from);
+uint64_t my_str_hash(my_str_view_t view);
+#endif //STRLIB_VIEW_H
@@ -0,0 +1,272 @@
+//
+// Потокова статистика слів: один прохід, класифікація символів блоками.
+//
+#include <string.h>
+#include "str_wordstat.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define BLOCK 16
+#define MY_STR_WORDSTAT_READ (64u << 10)
+
+//! Бітові маски класів символів блоку: біт i -- байт i.
+typedef struct {
+	unsigned word;	 // Символ слова
+	unsigned letter; // Символ слова, що починає кодову точку UTF-8
+	unsigned end;	 // Кінець речення: . ! ?
+	unsigned line;	 // \n
+	unsigned punct;	 // C2 чи E2 -- можливий початок розділового знака UTF-8
+} block_masks_t;
+
+//! Символ слова: латинська літера, цифра, апостроф чи будь-який байт UTF-8.
+//! Розділові знаки UTF-8 (C2 xx, E2 xx xx) з цих байтів вилучає utf8_punct().
+static int is_word_byte(unsigned char c) {
+	return (unsigned char) ((c | 0x20) - 'a') < 26 || (unsigned char) (c - '0') < 10 || c == '\'' || c >= 0x80;
+}
+
+static void masks_scalar(const unsigned char *p, size_t n, block_masks_t *m) {
+	memset(m, 0, sizeof(*m));
+	for (size_t i = 0; i < n; i++) {
+		unsigned bit = 1u << i;
+		unsigned char c = p[i];
+		if (is_word_byte(c)) {
+			m->word |= bit;
+			if ((c & 0xC0) != 0x80) {
+				m->letter |= bit;
+			}
+		} else if (c == '\n') {
+			m->line |= bit;
+		} else if (c == '.' || c == '!' || c == '?') {
+			m->end |= bit;
+		}
+		if (c == 0xC2 || c == 0xE2) {
+			m->punct |= bit;
+		}
+	}
+}
+
+#ifdef __SSE2__
+//! Те ж, що masks_scalar(), для повного блоку -- кількома порівняннями SSE2.
+static void masks_sse2(const unsigned char *p, block_masks_t *m) {
+	__m128i v = _mm_loadu_si128((const __m128i *) p);
+	// Діапазон [lo, lo + n) -- зсув до -128 і одне знакове порівняння.
+	__m128i alpha = _mm_cmplt_epi8(_mm_add_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8((char) (-128 - 'a'))),
+								   _mm_set1_epi8(-128 + 26));
+	__m128i digit = _mm_cmplt_epi8(_mm_add_epi8(v, _mm_set1_epi8((char) (-128 - '0'))), _mm_set1_epi8(-128 + 10));
+	__m128i apos = _mm_cmpeq_epi8(v, _mm_set1_epi8('\''));
+	__m128i cont = _mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8((char) 0xC0)), _mm_set1_epi8((char) 0x80));
+	__m128i end = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('.')), _mm_cmpeq_epi8(v, _mm_set1_epi8('!'))),
+							   _mm_cmpeq_epi8(v, _mm_set1_epi8('?')));
+	unsigned high = (unsigned) _mm_movemask_epi8(v);
+	m->word = (unsigned) _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), apos)) | high;
+	m->letter = m->word & ~(unsigned) _mm_movemask_epi8(cont);
+	m->line = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+	m->end = (unsigned) _mm_movemask_epi8(end);
+	m->punct = (unsigned) _mm_movemask_epi8(
+		_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8((char) 0xC2)), _mm_cmpeq_epi8(v, _mm_set1_epi8((char) 0xE2))));
+}
+#endif
+
+//! Довжина розділового знака UTF-8 з avail байт у p, 0 -- це не розділовий знак.
+//! Як і в str_segment.c: увесь C2 xx (нерозривний пробіл, «, » ...) і E2 xx xx
+//! (тире, …, лапки ...), крім ’ -- той, як і апостроф, належить слову.
+static unsigned punct_len(const unsigned char *p, size_t avail) {
+	if (avail < 2 || (p[1] & 0xC0) != 0x80) {
+		return 0;
+	}
+	if (p[0] == 0xC2) {
+		return 2;
+	}
+	if (avail < 3 || (p[2] & 0xC0) != 0x80 || (p[1] == 0x80 && p[2] == 0x99)) {
+		return 0;
+	}
+	return 3;
+}
+
+//! Зняти з масок блоку байти розділових знаків UTF-8; … -- ще й кінець речення.
+//! carry -- скільки байт на початку блоку належать знаку з попереднього блоку.
+//! Повертає те ж саме для наступного блоку.
+static unsigned utf8_punct(const unsigned char *p, unsigned n, size_t avail, unsigned carry, block_masks_t *m) {
+	unsigned sep = (1u << carry) - 1;
+	unsigned leads = m->punct & ((1u << n) - 1);
+	while (leads) {
+		unsigned i = (unsigned) __builtin_ctz(leads);
+		leads &= leads - 1;
+		unsigned len = punct_len(p + i, avail - i);
+		sep |= ((1u << len) - 1) << i;
+		if (len == 3 && p[i + 1] == 0x80 && p[i + 2] == 0xA6) {
+			m->end |= 1u << i;
+		}
+	}
+	m->word &= ~sep;
+	m->letter &= ~sep;
+	return (unsigned) __builtin_popcount(sep >> n);
+}
+
+//! Біти [from, to) маски.
+static unsigned bits_range(unsigned mask, unsigned from, unsigned to) {
+	unsigned hi = to >= 32 ? ~0u : (1u << to) - 1;
+	return mask & hi & ~((1u << from) - 1);
+}
+
+static void word_done(my_str_wordstat_t *stat) {
+	size_t len = stat->cur_len;
+	stat->hist[len < MY_STR_WORDSTAT_HIST ? len : MY_STR_WORDSTAT_HIST - 1]++;
+	stat->letters += len;
+	stat->in_word = 0;
+	stat->cur_len = 0;
+}
+
+//! Обробити n байт за масками. Цикл іде по межах слів і кінцях речень,
+//! а не по символах: у блоці на кожне слово -- кілька бітових операцій.
+static void process_block(my_str_wordstat_t *stat, const block_masks_t *m, unsigned n) {
+	unsigned all = n >= 32 ? ~0u : (1u << n) - 1;
+	unsigned word = m->word & all;
+	unsigned pos = 0;
+	stat->lines += (size_t) __builtin_popcount(m->line & all);
+
+	// Речення: перший кінець речення після хоч одного слова.
+	unsigned ends = m->end & all;
+	unsigned last = 0;
+	while (ends) {
+		unsigned e = (unsigned) __builtin_ctz(ends);
+		if (stat->after_word || bits_range(word, last, e)) {
+			stat->sentences++;
+			stat->after_word = 0;
+		}
+		last = e + 1;
+		ends &= ends - 1;
+	}
+	if (bits_range(word, last, n)) {
+		stat->after_word = 1;
+	}
+
+	while (pos < n) {
+		if (stat->in_word) {
+			unsigned gap = bits_range(~word, pos, n);
+			unsigned stop = gap ? (unsigned) __builtin_ctz(gap) : n;
+			stat->cur_len += (size_t) __builtin_popcount(bits_range(m->letter, pos, stop));
+			if (!gap) {
+				return;
+			}
+			word_done(stat);
+			pos = stop;
+		} else {
+			unsigned start = bits_range(word, pos, n);
+			if (!start) {
+				return;
+			}
+			pos = (unsigned) __builtin_ctz(start);
+			stat->in_word = 1;
+			stat->words++;
+		}
+	}
+}
+
+//! Почати нову статистику.
+void my_str_wordstat_init(my_str_wordstat_t *stat) {
+	memset(stat, 0, sizeof(*stat));
+}
+
+//! Обробити n байт, що починаються на межі символу і не обривають розділовий знак.
+static void feed_bytes(my_str_wordstat_t *stat, const unsigned char *p, size_t n) {
+	block_masks_t m;
+	unsigned carry = 0;
+	for (; n >= BLOCK; p += BLOCK, n -= BLOCK) {
+#ifdef __SSE2__
+		masks_sse2(p, &m);
+#else
+		masks_scalar(p, BLOCK, &m);
+#endif
+		if (m.punct || carry) {
+			carry = utf8_punct(p, BLOCK, n, carry, &m);
+		}
+		process_block(stat, &m, BLOCK);
+	}
+	if (n > 0) {
+		masks_scalar(p, n, &m);
+		if (m.punct || carry) {
+			utf8_punct(p, (unsigned) n, n, carry, &m);
+		}
+		process_block(stat, &m, (unsigned) n);
+	}
+}
+
+//! Обробити чергову порцію тексту. Слово чи розділовий знак UTF-8 може
+//! розриватися між порціями -- стан зберігається в stat; після останньої
+//! порції викличте my_str_wordstat_finish().
+void my_str_wordstat_feed(my_str_wordstat_t *stat, my_str_view_t text) {
+	const unsigned char *p = (const unsigned char *) text.data;
+	size_t n = text.size_m;
+	if (stat->tail_len > 0) {
+		// Дочитати знак, що почався в попередній порції.
+		unsigned char seq[3] = {stat->tail[0], stat->tail[1], 0};
+		size_t want = seq[0] == 0xC2 ? 2 : 3;
+		while (stat->tail_len < want && n > 0) {
+			seq[stat->tail_len++] = *p++;
+			n--;
+		}
+		if (stat->tail_len < want) {
+			memcpy(stat->tail, seq, stat->tail_len);
+			return;
+		}
+		stat->tail_len = 0;
+		feed_bytes(stat, seq, want);
+	}
+	// Незакінчений знак у кінці відкладається до наступної порції.
+	size_t keep = 0;
+	if (n >= 1 && (p[n - 1] == 0xC2 || p[n - 1] == 0xE2)) {
+		keep = 1;
+	} else if (n >= 2 && p[n - 2] == 0xE2) {
+		keep = 2;
+	}
+	feed_bytes(stat, p, n - keep);
+	memcpy(stat->tail, p + n - keep, keep);
+	stat->tail_len = keep;
+}
+
+//! Завершити незакінчене слово в кінці вводу.
+void my_str_wordstat_finish(my_str_wordstat_t *stat) {
+	if (stat->tail_len > 0) {
+		feed_bytes(stat, stat->tail, stat->tail_len);
+		stat->tail_len = 0;
+	}
+	if (stat->in_word) {
+		word_done(stat);
+	}
+}
+
+//! Додати завершену статистику from до into (напр., від різних потоків).
+void my_str_wordstat_merge(my_str_wordstat_t *into, const my_str_wordstat_t *from) {
+	into->words += from->words;
+	into->letters += from->letters;
+	into->sentences += from->sentences;
+	into->lines += from->lines;
+	for (size_t i = 0; i < MY_STR_WORDSTAT_HIST; i++) {
+		into->hist[i] += from->hist[i];
+	}
+}
+
+//! Прочитати файл до кінця блоками, додаючи до stat, і завершити його.
+//! Пам'ять -- сталий буфер, незалежно від розміру файлу.
+//! -1 -- нульовий вказівник, -2 -- помилка читання, 0 -- все ОК.
+int my_str_wordstat_file(my_str_wordstat_t *stat, FILE *file) {
+	if (stat == NULL || file == NULL) {
+		return -1;
+	}
+	char buf[MY_STR_WORDSTAT_READ];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+		my_str_view_t chunk = {buf, n};
+		my_str_wordstat_feed(stat, chunk);
+	}
+	my_str_wordstat_finish(stat);
+	return ferror(file) ? -2 : 0;
+}
+
+//! Середня довжина слова в символах, 0 -- якщо слів немає.
+double my_str_wordstat_average(const my_str_wordstat_t *stat) {
+	return stat->words ? (double) stat->letters / (double) stat->words : 0.0;
+}
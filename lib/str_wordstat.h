@@ -0,0 +1,29 @@
+#ifndef STRLIB_WORDSTAT_H
+#define STRLIB_WORDSTAT_H
+#include <stdio.h>
+#include "stringg.h"
+#include "str_view.h"
+
+#define MY_STR_WORDSTAT_HIST 32 // Слова довші за 31 символ -- в останньому стовпчику
+
+typedef struct
+{
+	size_t words;	  // Кількість слів
+	size_t letters;	  // Кількість символів у словах (UTF-8 -- кодових точок)
+	size_t sentences; // Кількість речень
+	size_t lines;	  // Кількість рядків
+	size_t hist[MY_STR_WORDSTAT_HIST]; // hist[i] -- кількість слів довжини i
+	size_t cur_len;	  // Довжина незакінченого слова
+	int in_word;	  // Порція закінчилася посеред слова
+	int after_word;	  // Після останнього кінця речення були слова
+	unsigned char tail[2]; // Незакінчений розділовий знак UTF-8 у кінці порції
+	size_t tail_len;
+} my_str_wordstat_t;
+
+void my_str_wordstat_init(my_str_wordstat_t* stat);
+void my_str_wordstat_feed(my_str_wordstat_t* stat, my_str_view_t text);
+void my_str_wordstat_finish(my_str_wordstat_t* stat);
+void my_str_wordstat_merge(my_str_wordstat_t* into, const my_str_wordstat_t* from);
+int my_str_wordstat_file(my_str_wordstat_t* stat, FILE* file);
+double my_str_wordstat_average(const my_str_wordstat_t* stat);
+#endif //STRLIB_WORDSTAT_H
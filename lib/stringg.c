@@ -4,7 +4,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <malloc.h>
-#include <mem.h>
+#include <string.h>
+#include "str_arena.h"
 
 typedef struct {
 	size_t capacity_m; // Розмір блока
@@ -35,6 +36,21 @@ int my_str_create(my_str_t *str, size_t buf_size) {
 	return 0;
 }
 
+//! Те ж, що й my_str_create(), але буфер береться з арени поточного
+//! потоку (див. str_arena.h). Така стрічка і далі росте в арені через
+//! my_str_reserve(), а звільняти її можна будь-яким потоком.
+//! 0 -- все ОК, -2 -- не вдалося виділити пам'ять.
+int my_str_create_arena(my_str_t *str, size_t buf_size) {
+	char *arr = my_str_arena_alloc(buf_size + 1);
+	if (arr == NULL) {
+		return -2;
+	}
+	str->data = arr;
+	str->capacity_m = (size_t) buf_size + 1;
+	str->size_m = 0;
+	return 0;
+}
+
 //! Збільшує буфер стрічки, із збереженням вмісту,
 //! якщо новий розмір більший за попередній,
 //! не робить нічого, якщо менший або рівний.
@@ -42,15 +58,23 @@ int my_str_create(my_str_t *str, size_t buf_size) {
 //! Для збільшення виділяє новий буфер, копіює вміст
 //! стрічки (size_m символів -- немає сенсу копіювати
 //! решту буфера) із старого буфера та звільняє його.
+//! Буфер з арени замінюється новим з арени поточного потоку.
 //! У випадку помилки повертає різні від'ємні числа, якщо все ОК -- 0.
 int my_str_reserve(my_str_t *str, size_t buf_size) {
 	if (buf_size > str->capacity_m) {
 		char *new;
-		new = malloc(buf_size + 1);   // <=== Виділили
+		if (my_str_arena_owns(str->data)) {
+			new = my_str_arena_alloc(buf_size + 1);
+		} else {
+			new = malloc(buf_size + 1);   // <=== Виділили
+		}
+		if (new == NULL) {
+			return -2;
+		}
 		for (int i = 0; i < str->size_m; i++) {
 			*(new + i) = *(str->data + i);
 		}
-		free(str->data);
+		my_str_arena_free(str->data);
 		str->data = new;
 		str->capacity_m = buf_size;
 		return 0;
@@ -61,7 +85,7 @@ int my_str_reserve(my_str_t *str, size_t buf_size) {
 //! Звільняє пам'ять, знищуючи стрічку.
 //! Аналог деструктора інших мов.
 void my_str_free(my_str_t *str) {
-	free(str->data);
+	my_str_arena_free(str->data);
 	str->size_m = 0;
 	str->capacity_m = 0;
 	str->data = NULL;
@@ -41,4 +41,5 @@ size_t my_str_size(const my_str_t* str);
 void my_str_free(my_str_t* str);
 int my_str_from_cstr(my_str_t* str, const char* cstr, size_t buf_size);
 int my_str_create(my_str_t* str, size_t buf_size);
+int my_str_create_arena(my_str_t* str, size_t buf_size);
 #endif //STRLIB_LIBRARY_H
\ No newline at end of file
@@ -0,0 +1,148 @@
+//
+// Перевірка my_str_reader_t на неблокуючому каналі: записи, розірвані
+// між читаннями, останній запис без роздільника, EAGAIN.
+//
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "str_reader.h"
+
+#define CHECK(cond)                                                      \
+	do {                                                                 \
+		if (!(cond)) {                                                   \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			return 1;                                                    \
+		}                                                                \
+	} while (0)
+
+#define RECORDS 100000
+
+static int expect_next(my_str_reader_t *reader, const char *want) {
+	my_str_view_t rec;
+	if (my_str_reader_next(reader, &rec) != 1) {
+		return 0;
+	}
+	return my_str_view_eq(rec, my_str_view_cstr(want));
+}
+
+//! Записи приходять шматками, що розривають їх у довільних місцях.
+static int test_split_records(void) {
+	int fds[2];
+	CHECK(pipe2(fds, O_NONBLOCK) == 0);
+	my_str_reader_t reader;
+	CHECK(my_str_reader_create(&reader, '\n', 0) == 0);
+	my_str_view_t rec;
+
+	// Порожній канал -- EAGAIN, а не кінець файлу.
+	CHECK(my_str_reader_fill(&reader, fds[0]) == -1);
+	CHECK(my_str_reader_next(&reader, &rec) == 0);
+
+	CHECK(write(fds[1], "alpha\nbe", 8) == 8);
+	CHECK(my_str_reader_fill(&reader, fds[0]) == 1);
+	CHECK(expect_next(&reader, "alpha"));
+	CHECK(my_str_reader_next(&reader, &rec) == 0);
+
+	CHECK(write(fds[1], "ta\n\ngam", 7) == 7);
+	CHECK(my_str_reader_fill(&reader, fds[0]) == 1);
+	CHECK(expect_next(&reader, "beta"));
+	CHECK(expect_next(&reader, ""));
+	CHECK(my_str_reader_next(&reader, &rec) == 0);
+	CHECK(my_str_reader_fill(&reader, fds[0]) == -1);
+
+	// Останній запис без роздільника віддається лише після кінця файлу.
+	CHECK(write(fds[1], "ma", 2) == 2);
+	close(fds[1]);
+	CHECK(my_str_reader_fill(&reader, fds[0]) == 1);
+	CHECK(my_str_reader_next(&reader, &rec) == 0);
+	CHECK(my_str_reader_fill(&reader, fds[0]) == 0);
+	CHECK(expect_next(&reader, "gamma"));
+	CHECK(my_str_reader_next(&reader, &rec) == 0);
+
+	my_str_reader_free(&reader);
+	close(fds[0]);
+	return 0;
+}
+
+//! Запис номер i -- "i:" і ще i % 300 літер.
+static size_t make_record(size_t i, char *buf) {
+	size_t len = (size_t) sprintf(buf, "%zu:", i);
+	for (size_t k = 0; k < i % 300; k++) {
+		buf[len++] = (char) ('a' + (i + k) % 26);
+	}
+	return len;
+}
+
+static void *writer(void *arg) {
+	int fd = *(int *) arg;
+	char *out = malloc(RECORDS * 330);
+	size_t len = 0;
+	for (size_t i = 0; i < RECORDS; i++) {
+		len += make_record(i, out + len);
+		out[len++] = '\n';
+	}
+	// Порції змінного розміру, щоб межі читань падали будь-куди.
+	size_t pos = 0;
+	unsigned seed = 1;
+	while (pos < len) {
+		size_t chunk = 1 + (size_t) rand_r(&seed) % 5000;
+		if (chunk > len - pos) {
+			chunk = len - pos;
+		}
+		ssize_t n = write(fd, out + pos, chunk);
+		if (n > 0) {
+			pos += (size_t) n;
+		}
+	}
+	free(out);
+	close(fd);
+	return NULL;
+}
+
+//! Багато записів через канал від іншого потоку, з очікуванням через poll().
+static int test_stream(void) {
+	int fds[2];
+	CHECK(pipe(fds) == 0);
+	CHECK(fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0);
+	pthread_t thread;
+	CHECK(pthread_create(&thread, NULL, writer, &fds[1]) == 0);
+
+	my_str_reader_t reader;
+	CHECK(my_str_reader_create(&reader, '\n', 64) == 0);
+	char want[330];
+	size_t got = 0;
+	int rc;
+	do {
+		rc = my_str_reader_fill(&reader, fds[0]);
+		if (rc == -1) {
+			struct pollfd p = {fds[0], POLLIN, 0};
+			poll(&p, 1, -1);
+			continue;
+		}
+		CHECK(rc >= 0);
+		my_str_view_t rec;
+		while (my_str_reader_next(&reader, &rec) == 1) {
+			my_str_view_t exp = {want, make_record(got, want)};
+			CHECK(got < RECORDS && my_str_view_eq(rec, exp));
+			got++;
+		}
+	} while (rc != 0);
+	CHECK(got == RECORDS);
+
+	pthread_join(thread, NULL);
+	my_str_reader_free(&reader);
+	close(fds[0]);
+	return 0;
+}
+
+int main(void) {
+	if (test_split_records() != 0 || test_stream() != 0) {
+		return 1;
+	}
+	printf("test_reader: ok\n");
+	return 0;
+}